@@ -7,6 +7,7 @@
 #include "views/ViewController.h"
 #include "FileData.h"
 #include "FileFilterIndex.h"
+#include "GamelistWriter.h"
 #include "Log.h"
 #include "Settings.h"
 #include "SystemData.h"
@@ -225,20 +226,24 @@ void CollectionSystemManager::refreshCollectionSystems(FileData* file)
 	if (!file->getSystem()->isGameSystem() || file->getType() != GAME)
 		return;
 
-	std::map<std::string, CollectionSystemData> allCollections;
-	allCollections.insert(mAutoCollectionSystemsData.cbegin(), mAutoCollectionSystemsData.cend());
-	allCollections.insert(mCustomCollectionSystemsData.cbegin(), mCustomCollectionSystemsData.cend());
+	for(auto sysDataIt = mAutoCollectionSystemsData.cbegin(); sysDataIt != mAutoCollectionSystemsData.cend(); sysDataIt++)
+	{
+		updateCollectionSystem(file, sysDataIt->second);
+	}
 
-	for(auto sysDataIt = allCollections.cbegin(); sysDataIt != allCollections.cend(); sysDataIt++)
+	for(auto sysDataIt = mCustomCollectionSystemsData.cbegin(); sysDataIt != mCustomCollectionSystemsData.cend(); sysDataIt++)
 	{
 		updateCollectionSystem(file, sysDataIt->second);
 	}
 }
 
-void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionSystemData sysData)
+void CollectionSystemManager::updateCollectionSystem(FileData* file, const CollectionSystemData& sysData)
 {
 	if (sysData.isPopulated)
 	{
+		// the collection is sorted already, only the one game has to be put in its place
+		const FileData::SortType sortType = getSortTypeFromString(sysData.decl.defaultSort);
+
 		// collection files use the full path as key, to avoid clashes
 		std::string key = file->getFullPath();
 
@@ -252,9 +257,8 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 		if (found) {
 			// if we found it, we need to update it
 			FileData* collectionEntry = children.at(key);
-			// remove from index, so we can re-index metadata after refreshing
+			// remove from index, so we can re-index its changed metadata
 			fileIndex->removeFromIndex(collectionEntry);
-			collectionEntry->refreshMetadata();
 			// found and we are removing
 			if (name == "favorites" && file->metadata.get("favorite") == "false") {
 				// need to check if still marked as favorite, if not remove
@@ -264,6 +268,7 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 			{
 				// re-index with new metadata
 				fileIndex->addToIndex(collectionEntry);
+				rootFolder->resortChild(collectionEntry, sortType);
 				ViewController::get()->onFileChanged(collectionEntry, FILE_METADATA_CHANGED);
 			}
 		}
@@ -273,13 +278,12 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 			if (name == "recent" && file->metadata.get("playcount") > "0" && includeFileInAutoCollections(file) ||
 				name == "favorites" && file->metadata.get("favorite") == "true") {
 				CollectionFileData* newGame = new CollectionFileData(file, curSys);
-				rootFolder->addChild(newGame);
+				rootFolder->addChildSorted(newGame, sortType);
 				fileIndex->addToIndex(newGame);
 				ViewController::get()->onFileChanged(file, FILE_METADATA_CHANGED);
-				ViewController::get()->getGameListView(curSys)->onFileChanged(newGame, FILE_METADATA_CHANGED);
+				ViewController::get()->onFileChanged(newGame, FILE_METADATA_CHANGED);
 			}
 		}
-		rootFolder->sort(getSortTypeFromString(mCollectionSystemDeclsIndex[name].defaultSort));
 		if (name == "recent")
 		{
 			trimCollectionCount(rootFolder, LAST_PLAYED_MAX);
@@ -498,10 +502,9 @@ bool CollectionSystemManager::toggleGameInCollection(FileData* file)
 			{
 				// we didn't find it here, we should add it
 				CollectionFileData* newGame = new CollectionFileData(file, sysData);
-				rootFolder->addChild(newGame);
+				rootFolder->addChildSorted(newGame, getSortTypeFromString(mEditingCollectionSystemData->decl.defaultSort));
 				fileIndex->addToIndex(newGame);
 				ViewController::get()->getGameListView(systemViewToUpdate)->onFileChanged(newGame, FILE_METADATA_CHANGED);
-				rootFolder->sort(getSortTypeFromString(mEditingCollectionSystemData->decl.defaultSort));
 				ViewController::get()->onFileChanged(systemViewToUpdate->getRootFolder(), FILE_SORTED);
 				// add to bundle index as well, if needed
 				if(systemViewToUpdate != sysData)
@@ -527,6 +530,7 @@ bool CollectionSystemManager::toggleGameInCollection(FileData* file)
 			}
 			file->getSourceFileData()->getSystem()->getIndex()->addToIndex(file);
 			refreshCollectionSystems(file->getSourceFileData());
+			GamelistWriter::getInstance()->markDirty(file->getSourceFileData()->getSystem());
 		}
 
 		if (sysName == "favorites")
@@ -54,11 +54,11 @@ public:
 	void updateSystemsList();
 
 	void refreshCollectionSystems(FileData* file);
-	void updateCollectionSystem(FileData* file, CollectionSystemData sysData);
+	void updateCollectionSystem(FileData* file, const CollectionSystemData& sysData);
 	void deleteCollectionFiles(FileData* file);
 
-	inline std::map<std::string, CollectionSystemData> getAutoCollectionSystems() { return mAutoCollectionSystemsData; };
-	inline std::map<std::string, CollectionSystemData> getCustomCollectionSystems() { return mCustomCollectionSystemsData; };
+	inline const std::map<std::string, CollectionSystemData>& getAutoCollectionSystems() const { return mAutoCollectionSystemsData; };
+	inline const std::map<std::string, CollectionSystemData>& getCustomCollectionSystems() const { return mCustomCollectionSystemsData; };
 	inline SystemData* getCustomCollectionsBundle() { return mCustomCollectionsBundle; };
 	std::vector<std::string> getUnusedSystemsFromTheme();
 	SystemData* addNewCustomCollection(std::string name);
@@ -0,0 +1,125 @@
+#include "DirectoryCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "CacheFile.h"
+#include "Log.h"
+
+// bump this whenever the layout below changes, old caches are then simply ignored
+static const char     CACHE_MAGIC[4] = { 'E', 'S', 'D', 'C' };
+static const uint32_t CACHE_VERSION  = 2;
+
+// folder count, then per folder: path, mtime in ns, entry count and per entry: path, flags
+
+static const uint8_t ENTRY_DIRECTORY = 0x01;
+static const uint8_t ENTRY_HIDDEN    = 0x02;
+
+DirectoryCache::DirectoryCache(const std::string& name) : mName(name), mHits(0), mMisses(0)
+{
+	CacheReader reader;
+	if(!reader.load(getCacheFilePath("directories/" + mName + ".bin"), CACHE_MAGIC, CACHE_VERSION))
+		return;
+
+	uint32_t folderCount;
+	if(!reader.read(&folderCount))
+		return;
+
+	for(uint32_t i = 0; i < folderCount; i++)
+	{
+		std::string path;
+		int64_t mtime;
+		uint32_t entryCount;
+		if(!reader.readString(&path) || !reader.read(&mtime) || !reader.read(&entryCount))
+			break;
+
+		Folder& folder = mFolders[path];
+		folder.mtime = (long long)mtime;
+		folder.visited = false;
+		folder.content.resize(entryCount);
+
+		for(auto it = folder.content.begin(); it != folder.content.end(); ++it)
+		{
+			uint8_t flags;
+			if(!reader.readString(&it->path) || !reader.read(&flags))
+			{
+				LOG(LogWarning) << "Directory cache for system \"" << mName << "\" is corrupt, ignoring it";
+				mFolders.clear();
+				return;
+			}
+
+			it->isDirectory = (flags & ENTRY_DIRECTORY) != 0;
+			it->isHidden    = (flags & ENTRY_HIDDEN) != 0;
+		}
+	}
+}
+
+const DirectoryCache::Listing& DirectoryCache::getDirContent(const std::string& path, const long long mtime)
+{
+	Folder& folder = mFolders[path];
+	folder.visited = true;
+
+	// a new folder is default constructed with a 0 mtime, which never matches a real one
+	if(folder.mtime == mtime && mtime != 0)
+	{
+		mHits++;
+		return folder.content;
+	}
+
+	mMisses++;
+	folder.mtime = mtime;
+	folder.content.clear();
+
+	const Utils::FileSystem::stringList dirContent = Utils::FileSystem::getDirContent(path);
+	folder.content.reserve(dirContent.size());
+
+	for(auto it = dirContent.cbegin(); it != dirContent.cend(); ++it)
+	{
+		Entry entry;
+		entry.path        = *it;
+		entry.isDirectory = Utils::FileSystem::isDirectory(*it);
+		entry.isHidden    = Utils::FileSystem::isHidden(*it);
+		folder.content.push_back(entry);
+	}
+
+	return folder.content;
+}
+
+void DirectoryCache::save()
+{
+	// nothing changed, the file on disk is still good
+	if(mMisses == 0)
+	{
+		bool allVisited = true;
+		for(auto it = mFolders.cbegin(); it != mFolders.cend() && allVisited; ++it)
+			allVisited = it->second.visited;
+
+		if(allVisited)
+			return;
+	}
+
+	CacheWriter writer(CACHE_MAGIC, CACHE_VERSION);
+
+	uint32_t folderCount = 0;
+	for(auto it = mFolders.cbegin(); it != mFolders.cend(); ++it)
+		if(it->second.visited)
+			folderCount++;
+	writer.write(folderCount);
+
+	for(auto it = mFolders.cbegin(); it != mFolders.cend(); ++it)
+	{
+		const Folder& folder = it->second;
+		if(!folder.visited)
+			continue;
+
+		writer.writeString(it->first);
+		writer.write((int64_t)folder.mtime);
+		writer.write((uint32_t)folder.content.size());
+
+		for(auto entryIt = folder.content.cbegin(); entryIt != folder.content.cend(); ++entryIt)
+		{
+			writer.writeString(entryIt->path);
+			writer.write((uint8_t)((entryIt->isDirectory ? ENTRY_DIRECTORY : 0) | (entryIt->isHidden ? ENTRY_HIDDEN : 0)));
+		}
+	}
+
+	writer.save(getCacheFilePath("directories/" + mName + ".bin"));
+}
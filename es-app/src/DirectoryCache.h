@@ -0,0 +1,48 @@
+#pragma once
+#ifndef ES_APP_DIRECTORY_CACHE_H
+#define ES_APP_DIRECTORY_CACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Persisted directory listings for a system's ROM folders, keyed by path and modification time.
+// Folders that didn't change since the last scan are listed from the cache instead of being read and stat()'ed again.
+class DirectoryCache
+{
+public:
+	struct Entry
+	{
+		std::string path;
+		bool isDirectory;
+		bool isHidden;
+	};
+	typedef std::vector<Entry> Listing;
+
+	DirectoryCache(const std::string& name);
+
+	// Returns the content of a folder, reading it from disk only if it changed since it was cached.
+	// mtime is in nanoseconds, see Utils::FileSystem::getModifiedTimeNs().
+	const Listing& getDirContent(const std::string& path, const long long mtime);
+
+	// Writes the folders listed since construction, dropping the ones that weren't visited anymore.
+	void save();
+
+	inline unsigned int getHits() const { return mHits; }
+	inline unsigned int getMisses() const { return mMisses; }
+
+private:
+	struct Folder
+	{
+		long long mtime;
+		Listing content;
+		bool visited;
+	};
+
+	std::string mName;
+	std::unordered_map<std::string, Folder> mFolders;
+	unsigned int mHits;
+	unsigned int mMisses;
+};
+
+#endif // ES_APP_DIRECTORY_CACHE_H
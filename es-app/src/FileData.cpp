@@ -2,21 +2,25 @@
 
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
+#include "utils/ThreadPool.h"
 #include "utils/TimeUtil.h"
 #include "AudioManager.h"
 #include "CollectionSystemManager.h"
 #include "FileFilterIndex.h"
 #include "FileSorts.h"
+#include "GamelistWriter.h"
 #include "Log.h"
 #include "MameNames.h"
+#include "MediaIndex.h"
 #include "platform.h"
 #include "SystemData.h"
 #include "VolumeControl.h"
 #include "Window.h"
+#include <algorithm>
 #include <assert.h>
 
 FileData::FileData(FileType type, const std::string& path, SystemEnvironmentData* envData, SystemData* system)
-	: mType(type), mPath(path), mSystem(system), mEnvData(envData), mSourceFileData(NULL), mParent(NULL), metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: mType(type), mPath(path), mSystem(system), mEnvData(envData), mSourceFileData(NULL), mCollectionEntries(0), mParent(NULL), metadata(*new MetaDataList(type == GAME ? GAME_METADATA : FOLDER_METADATA)), mFilteredIndex(NULL), mFilteredVersion(0), mSortKeys(NULL), mSortKeysVersion(0) // metadata is REALLY set in the constructor!
 {
 	// metadata needs at least a name field (since that's what getName() will return)
 	if(metadata.get("name").empty())
@@ -24,6 +28,13 @@ FileData::FileData(FileType type, const std::string& path, SystemEnvironmentData
 	mSystemName = system->getName();
 }
 
+FileData::FileData(FileData* source, SystemData* system)
+	: mType(source->getType()), mPath(source->getPath()), mSystem(system), mEnvData(source->getSystemEnvData()), mSourceFileData(source), mCollectionEntries(0), mParent(NULL), metadata(source->metadata), mFilteredIndex(NULL), mFilteredVersion(0), mSortKeys(NULL), mSortKeysVersion(0)
+{
+	mSystemName = source->getSystem()->getName();
+	source->mCollectionEntries++;
+}
+
 FileData::~FileData()
 {
 	if(mParent)
@@ -33,15 +44,31 @@ FileData::~FileData()
 		mSystem->getIndex()->removeFromIndex(this);
 
 	mChildren.clear();
+	delete mSortKeys;
+
+	// the metadata of a collection entry belongs to its source, which the entries must not outlive
+	if(mSourceFileData == NULL)
+	{
+		assert(mCollectionEntries == 0);
+		delete &metadata;
+	}
+	else
+	{
+		mSourceFileData->mCollectionEntries--;
+	}
 }
 
 std::string FileData::getDisplayName() const
 {
-	std::string stem = Utils::FileSystem::getStem(mPath);
-	if(mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE) || mSystem->hasPlatformId(PlatformIds::NEOGEO))
-		stem = MameNames::getInstance()->getRealName(stem);
+	// the path never changes, so neither does the name
+	if(mDisplayName.empty())
+	{
+		mDisplayName = Utils::FileSystem::getStem(mPath);
+		if(mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE) || mSystem->hasPlatformId(PlatformIds::NEOGEO))
+			mDisplayName = MameNames::getInstance()->getRealName(mDisplayName);
+	}
 
-	return stem;
+	return mDisplayName;
 }
 
 std::string FileData::getCleanName() const
@@ -49,6 +76,29 @@ std::string FileData::getCleanName() const
 	return Utils::String::removeParenthesis(this->getDisplayName());
 }
 
+std::string FileData::getLocalMediaPath(const char* suffix, bool tryImageExtensions) const
+{
+	// local media lives in the images/ folder of the system the file really belongs to
+	SystemData* system = (mSourceFileData ? mSourceFileData : this)->mSystem;
+	MediaIndex* mediaIndex = system->getMediaIndex();
+	if(!mediaIndex)
+		return "";
+
+	const std::string name = getDisplayName() + suffix;
+	if(!tryImageExtensions)
+		return mediaIndex->getPath(name);
+
+	const char* extList[2] = { ".png", ".jpg" };
+	for(int i = 0; i < 2; i++)
+	{
+		std::string path = mediaIndex->getPath(name + extList[i]);
+		if(!path.empty())
+			return path;
+	}
+
+	return "";
+}
+
 const std::string FileData::getThumbnailPath() const
 {
 	std::string thumbnail = metadata.get("thumbnail");
@@ -60,18 +110,7 @@ const std::string FileData::getThumbnailPath() const
 
 		// no image, try to use local image
 		if(thumbnail.empty())
-		{
-			const char* extList[2] = { ".png", ".jpg" };
-			for(int i = 0; i < 2; i++)
-			{
-				if(thumbnail.empty())
-				{
-					std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-image" + extList[i];
-					if(Utils::FileSystem::exists(path))
-						thumbnail = path;
-				}
-			}
-		}
+			thumbnail = getLocalMediaPath("-image", true);
 	}
 
 	return thumbnail;
@@ -79,27 +118,33 @@ const std::string FileData::getThumbnailPath() const
 
 const std::string& FileData::getName()
 {
-	return metadata.get("name");
+	return metadata.get(META_NAME);
 }
 
 const std::string& FileData::getSortName()
 {
-	if (metadata.get("sortname").empty())
-		return metadata.get("name");
+	if (metadata.get(META_SORTNAME).empty())
+		return metadata.get(META_NAME);
 	else
-		return metadata.get("sortname");
+		return metadata.get(META_SORTNAME);
 }
 
 const std::vector<FileData*>& FileData::getChildrenListToDisplay() {
 
 	FileFilterIndex* idx = CollectionSystemManager::get()->getSystemToView(mSystem)->getIndex();
 	if (idx->isFiltered()) {
-		mFilteredChildren.clear();
-		for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
-		{
-			if (idx->showFile((*it))) {
-				mFilteredChildren.push_back(*it);
+		// only rebuild the list if the filters, the indexed games or our children changed since
+		if (mFilteredIndex != idx || mFilteredVersion != idx->getVersion()) {
+			mFilteredChildren.clear();
+			for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
+			{
+				if (idx->showFile((*it))) {
+					mFilteredChildren.push_back(*it);
+				}
 			}
+
+			mFilteredIndex = idx;
+			mFilteredVersion = idx->getVersion();
 		}
 
 		return mFilteredChildren;
@@ -116,11 +161,7 @@ const std::string FileData::getVideoPath() const
 
 	// no video, try to use local video
 	if(video.empty())
-	{
-		std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-video.mp4";
-		if(Utils::FileSystem::exists(path))
-			video = path;
-	}
+		video = getLocalMediaPath("-video.mp4", false);
 
 	return video;
 }
@@ -131,18 +172,7 @@ const std::string FileData::getMarqueePath() const
 
 	// no marquee, try to use local marquee
 	if(marquee.empty())
-	{
-		const char* extList[2] = { ".png", ".jpg" };
-		for(int i = 0; i < 2; i++)
-		{
-			if(marquee.empty())
-			{
-				std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-marquee" + extList[i];
-				if(Utils::FileSystem::exists(path))
-					marquee = path;
-			}
-		}
-	}
+		marquee = getLocalMediaPath("-marquee", true);
 
 	return marquee;
 }
@@ -153,18 +183,7 @@ const std::string FileData::getImagePath() const
 
 	// no image, try to use local image
 	if(image.empty())
-	{
-		const char* extList[2] = { ".png", ".jpg" };
-		for(int i = 0; i < 2; i++)
-		{
-			if(image.empty())
-			{
-				std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-image" + extList[i];
-				if(Utils::FileSystem::exists(path))
-					image = path;
-			}
-		}
-	}
+		image = getLocalMediaPath("-image", true);
 
 	return image;
 }
@@ -222,6 +241,7 @@ void FileData::addChild(FileData* file)
 		mChildrenByFilename[key] = file;
 		mChildren.push_back(file);
 		file->mParent = this;
+		mFilteredIndex = NULL;
 	}
 }
 
@@ -236,6 +256,7 @@ void FileData::removeChild(FileData* file)
 		{
 			file->mParent = NULL;
 			mChildren.erase(it);
+			mFilteredIndex = NULL;
 			return;
 		}
 	}
@@ -245,9 +266,84 @@ void FileData::removeChild(FileData* file)
 
 }
 
+const FileData::SortKeys& FileData::getSortKeys() const
+{
+	// same metadata and system name, so the same keys
+	if(mSourceFileData != NULL)
+		return mSourceFileData->getSortKeys();
+
+	if(!mSortKeys || mSortKeysVersion != metadata.getVersion())
+	{
+		if(!mSortKeys)
+			mSortKeys = new SortKeys();
+
+		const std::string& sortName = metadata.get(META_SORTNAME);
+		mSortKeys->name      = Utils::String::toUpper(sortName.empty() ? metadata.get(META_NAME) : sortName);
+		mSortKeys->genre     = Utils::String::toUpper(metadata.get(META_GENRE));
+		mSortKeys->developer = Utils::String::toUpper(metadata.get(META_DEVELOPER));
+		mSortKeys->publisher = Utils::String::toUpper(metadata.get(META_PUBLISHER));
+		mSortKeys->system    = Utils::String::toUpper(mSystemName);
+		mSortKeysVersion     = metadata.getVersion();
+	}
+
+	return *mSortKeys;
+}
+
+// folders with at least this many children are sorted in chunks on a thread pool, the chunks are then merged
+static const size_t PARALLEL_SORT_THRESHOLD = 4096;
+
+static void sortFiles(std::vector<FileData*>& files, FileData::ComparisonFunction& comparator)
+{
+	// the comparators only read the sort keys, so build them before any of the sorting threads can race for them.
+	// systems loading in parallel already keep every core busy, they sort on their own worker instead
+	if(files.size() < PARALLEL_SORT_THRESHOLD || Utils::ThreadPool::isWorkerThread())
+	{
+		for(auto it = files.cbegin(); it != files.cend(); it++)
+			(*it)->getSortKeys();
+
+		std::stable_sort(files.begin(), files.end(), comparator);
+		return;
+	}
+
+	// one pool for every sort, started on first use. Only the main thread gets here, so nothing else waits on it
+	static Utils::ThreadPool pool;
+	const size_t numChunks = pool.getThreadCount();
+	std::vector<size_t> bounds;
+	for(size_t i = 0; i <= numChunks; i++)
+		bounds.push_back((files.size() * i) / numChunks);
+
+	for(size_t i = 0; i < numChunks; i++)
+	{
+		const std::vector<FileData*>::iterator begin = files.begin() + bounds[i];
+		const std::vector<FileData*>::iterator end   = files.begin() + bounds[i + 1];
+		pool.queueJob([begin, end, &comparator]
+		{
+			for(auto it = begin; it != end; it++)
+				(*it)->getSortKeys();
+
+			std::stable_sort(begin, end, comparator);
+		});
+	}
+	pool.wait();
+
+	// merge neighbouring chunks until a single one is left, keeping the result identical to a single stable_sort
+	for(size_t width = 1; width < numChunks; width *= 2)
+	{
+		for(size_t i = 0; i + width < numChunks; i += width * 2)
+		{
+			const std::vector<FileData*>::iterator begin  = files.begin() + bounds[i];
+			const std::vector<FileData*>::iterator middle = files.begin() + bounds[i + width];
+			const std::vector<FileData*>::iterator end    = files.begin() + bounds[std::min(i + width * 2, numChunks)];
+			pool.queueJob([begin, middle, end, &comparator] { std::inplace_merge(begin, middle, end, comparator); });
+		}
+		pool.wait();
+	}
+}
+
 void FileData::sort(ComparisonFunction& comparator, bool ascending)
 {
-	std::stable_sort(mChildren.begin(), mChildren.end(), comparator);
+	sortFiles(mChildren, comparator);
+	mFilteredIndex = NULL;
 
 	for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
 	{
@@ -264,6 +360,47 @@ void FileData::sort(const SortType& type)
 	sort(*type.comparisonFunction, type.ascending);
 }
 
+// where sort() would put the file: after its equals when ascending, and before them when descending since that is a reversed ascending sort
+static std::vector<FileData*>::iterator findSortedPosition(std::vector<FileData*>& files, FileData* file, const FileData::SortType& type)
+{
+	FileData::ComparisonFunction* comparator = type.comparisonFunction;
+
+	if(type.ascending)
+		return std::upper_bound(files.begin(), files.end(), file, comparator);
+
+	return std::lower_bound(files.begin(), files.end(), file, [comparator](const FileData* a, const FileData* b) { return comparator(b, a); });
+}
+
+void FileData::addChildSorted(FileData* file, const SortType& type)
+{
+	assert(mType == FOLDER);
+	assert(file->getParent() == NULL);
+
+	const std::string key = file->getKey();
+	if (mChildrenByFilename.find(key) == mChildrenByFilename.cend())
+	{
+		mChildrenByFilename[key] = file;
+		mChildren.insert(findSortedPosition(mChildren, file, type), file);
+		file->mParent = this;
+		mFilteredIndex = NULL;
+	}
+}
+
+void FileData::resortChild(FileData* file, const SortType& type)
+{
+	assert(mType == FOLDER);
+	assert(file->getParent() == this);
+
+	// its keys changed, so it has to be found by address
+	auto it = std::find(mChildren.begin(), mChildren.end(), file);
+	if(it == mChildren.end())
+		return;
+
+	mChildren.erase(it);
+	mChildren.insert(findSortedPosition(mChildren, file, type), file);
+	mFilteredIndex = NULL;
+}
+
 void FileData::launchGame(Window* window)
 {
 	LOG(LogInfo) << "Attempting to launch game...";
@@ -304,17 +441,12 @@ void FileData::launchGame(Window* window)
 	//update last played time
 	gameToUpdate->metadata.set("lastplayed", Utils::Time::DateTime(Utils::Time::now()));
 	CollectionSystemManager::get()->refreshCollectionSystems(gameToUpdate);
+	GamelistWriter::getInstance()->markDirty(gameToUpdate->getSystem());
 }
 
 CollectionFileData::CollectionFileData(FileData* file, SystemData* system)
-	: FileData(file->getSourceFileData()->getType(), file->getSourceFileData()->getPath(), file->getSourceFileData()->getSystemEnvData(), system)
+	: FileData(file->getSourceFileData(), system), mCollectionFileNameVersion(0)
 {
-	// we use this constructor to create a clone of the filedata, and change its system
-	mSourceFileData = file->getSourceFileData();
-	refreshMetadata();
-	mParent = NULL;
-	metadata = mSourceFileData->metadata;
-	mSystemName = mSourceFileData->getSystem()->getName();
 }
 
 CollectionFileData::~CollectionFileData()
@@ -334,25 +466,18 @@ FileData* CollectionFileData::getSourceFileData()
 	return mSourceFileData;
 }
 
-void CollectionFileData::refreshMetadata()
-{
-	metadata = mSourceFileData->metadata;
-	mDirty = true;
-}
-
 const std::string& CollectionFileData::getName()
 {
-	if (mDirty) {
-		mCollectionFileName  = Utils::String::removeParenthesis(mSourceFileData->metadata.get("name"));
-		mCollectionFileName += " [" + Utils::String::toUpper(mSourceFileData->getSystem()->getName()) + "]";
-		mDirty = false;
+	if (mCollectionFileName.empty() || mCollectionFileNameVersion != metadata.getVersion()) {
+		mCollectionFileName  = Utils::String::removeParenthesis(metadata.get(META_NAME));
+		mCollectionFileName += " [" + Utils::String::toUpper(mSystemName) + "]";
+		mCollectionFileNameVersion = metadata.getVersion();
 	}
 	return mCollectionFileName;
 }
 
 // returns Sort Type based on a string description
 FileData::SortType getSortTypeFromString(std::string desc) {
-	std::vector<FileData::SortType> SortTypes = FileSorts::SortTypes;
 	// find it
 	for(unsigned int i = 0; i < FileSorts::SortTypes.size(); i++)
 	{
@@ -6,6 +6,7 @@
 #include "MetaData.h"
 #include <unordered_map>
 
+class FileFilterIndex;
 class SystemData;
 class Window;
 struct SystemEnvironmentData;
@@ -58,8 +59,6 @@ public:
 
 	inline bool isPlaceHolder() { return mType == PLACEHOLDER; };
 
-	virtual inline void refreshMetadata() { return; };
-
 	virtual std::string getKey();
 	const bool isArcadeAsset();
 	inline std::string getFullPath() { return getPath(); };
@@ -88,14 +87,40 @@ public:
 
 	void sort(ComparisonFunction& comparator, bool ascending = true);
 	void sort(const SortType& type);
-	MetaDataList metadata;
+
+	// For children that are sorted by type already: adds a child where sort(type) would put it,
+	// or moves one there after its metadata changed. A binary search instead of sorting them all again.
+	void addChildSorted(FileData* file, const SortType& type);
+	void resortChild(FileData* file, const SortType& type);
+	MetaDataList& metadata; // a collection entry's is the one of the game it stands for, changing it changes both,
+	                        // so a game must outlive its collection entries
+
+	// Upper cased strings the comparators in FileSorts work on, numeric sorts use the typed metadata values instead.
+	struct SortKeys
+	{
+		std::string name; // sortname, or name if there is none
+		std::string genre;
+		std::string developer;
+		std::string publisher;
+		std::string system;
+	};
+
+	// Built on first use and rebuilt when the metadata changed since. Collection entries use the ones of their source.
+	const SortKeys& getSortKeys() const;
 
 protected:
+	// Shares the metadata of source instead of copying it, for CollectionFileData
+	FileData(FileData* source, SystemData* system);
+
 	FileData* mSourceFileData;
+	unsigned int mCollectionEntries; // alive and sharing our metadata
 	FileData* mParent;
 	std::string mSystemName;
 
 private:
+	// Looks "<display name><suffix>" up in the system's images/ folder, trying .png and .jpg if tryImageExtensions.
+	std::string getLocalMediaPath(const char* suffix, bool tryImageExtensions) const;
+
 	FileType mType;
 	std::string mPath;
 	SystemEnvironmentData* mEnvData;
@@ -103,6 +128,11 @@ private:
 	std::unordered_map<std::string,FileData*> mChildrenByFilename;
 	std::vector<FileData*> mChildren;
 	std::vector<FileData*> mFilteredChildren;
+	FileFilterIndex* mFilteredIndex; // index and version mFilteredChildren was built with, NULL if it is stale
+	unsigned int mFilteredVersion;
+	mutable SortKeys* mSortKeys;
+	mutable unsigned int mSortKeysVersion;
+	mutable std::string mDisplayName;
 };
 
 class CollectionFileData : public FileData
@@ -111,13 +141,12 @@ public:
 	CollectionFileData(FileData* file, SystemData* system);
 	~CollectionFileData();
 	const std::string& getName();
-	void refreshMetadata();
 	FileData* getSourceFileData();
 	std::string getKey();
 private:
-	// needs to be updated when metadata changes
+	// "name [SYSTEM]", rebuilt when the metadata changed since
 	std::string mCollectionFileName;
-	bool mDirty;
+	unsigned int mCollectionFileNameVersion;
 };
 
 FileData::SortType getSortTypeFromString(std::string desc);
@@ -10,8 +10,28 @@
 #define UNKNOWN_LABEL "UNKNOWN"
 #define INCLUDE_UNKNOWN false;
 
+static void setBit(std::vector<uint64_t>& bits, const size_t id)
+{
+	if(bits.size() <= (id / 64))
+		bits.resize((id / 64) + 1, 0);
+
+	bits[id / 64] |= ((uint64_t)1 << (id % 64));
+}
+
+static void clearBit(std::vector<uint64_t>& bits, const size_t id)
+{
+	if(bits.size() > (id / 64))
+		bits[id / 64] &= ~((uint64_t)1 << (id % 64));
+}
+
+static bool testBit(const std::vector<uint64_t>& bits, const size_t id)
+{
+	return (bits.size() > (id / 64)) && (bits[id / 64] & ((uint64_t)1 << (id % 64)));
+}
+
 FileFilterIndex::FileFilterIndex()
-	: filterByFavorites(false), filterByGenre(false), filterByHidden(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false)
+	: filterByFavorites(false), filterByGenre(false), filterByHidden(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false),
+	  mGameIdCount(0), mFilterResultDirty(true), mVersion(0)
 {
 	clearAllFilters();
 	FilterDataDecl filterDecls[] = {
@@ -84,6 +104,14 @@ void FileFilterIndex::resetIndex()
 	clearIndex(favoritesIndexAllKeys);
 	clearIndex(hiddenIndexAllKeys);
 	clearIndex(kidGameIndexAllKeys);
+
+	mGameIds.clear();
+	mFreeGameIds.clear();
+	mGameIdCount = 0;
+	mIndexedGames.clear();
+	for(int i = 0; i < FILTER_TYPE_COUNT; i++)
+		mPostings[i].clear();
+	filtersChanged();
 }
 
 std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType type, bool getSecondary)
@@ -180,26 +208,104 @@ std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType typ
 	return key;
 }
 
+void FileFilterIndex::getIndexKeys(FileData* game, IndexKeys& keys)
+{
+	for(std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it)
+	{
+		keys.keys[it->type][0] = getIndexableKey(game, it->type, false);
+		keys.keys[it->type][1] = it->hasSecondaryKey ? getIndexableKey(game, it->type, true) : UNKNOWN_LABEL;
+	}
+}
+
+void FileFilterIndex::manageEntriesInIndex(const IndexKeys& keys, bool remove)
+{
+	manageGenreEntryInIndex(keys, remove);
+	managePlayerEntryInIndex(keys, remove);
+	managePubDevEntryInIndex(keys, remove);
+	manageRatingsEntryInIndex(keys, remove);
+	manageFavoritesEntryInIndex(keys, remove);
+	manageHiddenEntryInIndex(keys, remove);
+	manageKidGameEntryInIndex(keys, remove);
+}
+
 void FileFilterIndex::addToIndex(FileData* game)
 {
-	manageGenreEntryInIndex(game);
-	managePlayerEntryInIndex(game);
-	managePubDevEntryInIndex(game);
-	manageRatingsEntryInIndex(game);
-	manageFavoritesEntryInIndex(game);
-	manageHiddenEntryInIndex(game);
-	manageKidGameEntryInIndex(game);
+	// indexing it twice would count it twice
+	if(mGameIds.find(game) != mGameIds.cend())
+		removeFromIndex(game);
+
+	IndexKeys keys;
+	getIndexKeys(game, keys);
+	manageEntriesInIndex(keys, false);
+
+	IndexedGame& indexed = mGameIds[game];
+	if(!mFreeGameIds.empty())
+	{
+		indexed.id = mFreeGameIds.back();
+		mFreeGameIds.pop_back();
+	}
+	else
+	{
+		indexed.id = mGameIdCount++;
+	}
+	setBit(mIndexedGames, indexed.id);
+
+	// a game is listed under its primary key and, for the types that have one, its secondary key - just like showFile() used to look them up
+	for(int type = 0; type < FILTER_TYPE_COUNT; type++)
+	{
+		for(int i = 0; i < 2; i++)
+		{
+			indexed.postings[type][i] = NULL;
+			if(keys.keys[type][i].empty() || keys.keys[type][i] == UNKNOWN_LABEL)
+				continue;
+
+			Posting* posting = &(*mPostings[type].insert(std::make_pair(keys.keys[type][i], Bitset())).first);
+			setBit(posting->second, indexed.id);
+			indexed.postings[type][i] = posting;
+		}
+	}
+
+	filtersChanged();
 }
 
 void FileFilterIndex::removeFromIndex(FileData* game)
 {
-	manageGenreEntryInIndex(game, true);
-	managePlayerEntryInIndex(game, true);
-	managePubDevEntryInIndex(game, true);
-	manageRatingsEntryInIndex(game, true);
-	manageFavoritesEntryInIndex(game, true);
-	manageHiddenEntryInIndex(game, true);
-	manageKidGameEntryInIndex(game, true);
+	IndexKeys keys;
+	auto gameIt = mGameIds.find(game);
+
+	if(gameIt == mGameIds.cend())
+	{
+		// the custom collections bundle imports the counts of its collections, but not their games
+		getIndexKeys(game, keys);
+		manageEntriesInIndex(keys, true);
+		return;
+	}
+
+	// what it was indexed under, its metadata may have changed since - collection entries share it with their source game
+	const IndexedGame& indexed = gameIt->second;
+	for(int type = 0; type < FILTER_TYPE_COUNT; type++)
+	{
+		for(int i = 0; i < 2; i++)
+		{
+			Posting* posting = indexed.postings[type][i];
+			if(posting)
+			{
+				keys.keys[type][i] = posting->first;
+				clearBit(posting->second, indexed.id);
+			}
+			else
+			{
+				keys.keys[type][i] = UNKNOWN_LABEL;
+			}
+		}
+	}
+	manageEntriesInIndex(keys, true);
+
+	clearBit(mIndexedGames, indexed.id);
+	mFreeGameIds.push_back(indexed.id);
+	mGameIds.erase(gameIt);
+
+	filtersChanged();
 }
 
 void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>* values)
@@ -225,6 +331,7 @@ void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>*
 				}
 			}
 		}
+		filtersChanged();
 	}
 	return;
 }
@@ -237,9 +344,50 @@ void FileFilterIndex::clearAllFilters()
 		*(filterData.filteredByRef) = false;
 		filterData.currentFilteredKeys->clear();
 	}
+	filtersChanged();
 	return;
 }
 
+void FileFilterIndex::filtersChanged()
+{
+	mFilterResultDirty = true;
+	mVersion++;
+}
+
+void FileFilterIndex::updateFilterResult()
+{
+	if(!mFilterResultDirty)
+		return;
+
+	// AND over the filtered types of the OR over each type's filtered keys
+	mFilterResult = mIndexedGames;
+
+	for(std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it)
+	{
+		if(!*(it->filteredByRef))
+			continue;
+
+		const std::map<std::string, Bitset>& postings = mPostings[it->type];
+		Bitset matches(mFilterResult.size(), 0);
+
+		for(std::vector<std::string>::const_iterator keyIt = it->currentFilteredKeys->cbegin(); keyIt != it->currentFilteredKeys->cend(); ++keyIt)
+		{
+			auto postingIt = postings.find(*keyIt);
+			if(postingIt == postings.cend())
+				continue;
+
+			const Bitset& games = postingIt->second;
+			for(size_t i = 0; i < games.size() && i < matches.size(); i++)
+				matches[i] |= games[i];
+		}
+
+		for(size_t i = 0; i < mFilterResult.size(); i++)
+			mFilterResult[i] &= matches[i];
+	}
+
+	mFilterResultDirty = false;
+}
+
 void FileFilterIndex::resetFilters()
 {
 	clearAllFilters();
@@ -299,7 +447,7 @@ bool FileFilterIndex::showFile(FileData* game)
 	// if folder, needs further inspection - i.e. see if folder contains at least one element
 	// that should be shown
 	if (game->getType() == FOLDER) {
-		std::vector<FileData*> children = game->getChildren();
+		const std::vector<FileData*>& children = game->getChildren();
 		// iterate through all of the children, until there's a match
 
 		for (std::vector<FileData*>::const_iterator it = children.cbegin(); it != children.cend(); ++it ) {
@@ -311,6 +459,19 @@ bool FileFilterIndex::showFile(FileData* game)
 		return false;
 	}
 
+	// games in this index are a single bit lookup
+	auto idIt = mGameIds.find(game);
+	if (idIt != mGameIds.cend()) {
+		updateFilterResult();
+		return testBit(mFilterResult, idIt->second.id);
+	}
+
+	// the custom collections bundle only imports the keys of its collections, not their games
+	return matchesFilters(game);
+}
+
+bool FileFilterIndex::matchesFilters(FileData* game)
+{
 	bool keepGoing = false;
 
 	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it ) {
@@ -368,10 +529,10 @@ bool FileFilterIndex::isKeyBeingFilteredBy(std::string key, FilterIndexType type
 	return false;
 }
 
-void FileFilterIndex::manageGenreEntryInIndex(FileData* game, bool remove)
+void FileFilterIndex::manageGenreEntryInIndex(const IndexKeys& keys, bool remove)
 {
 
-	std::string key = getIndexableKey(game, GENRE_FILTER, false);
+	std::string key = keys.keys[GENRE_FILTER][0];
 
 	// flag for including unknowns
 	bool includeUnknown = INCLUDE_UNKNOWN;
@@ -384,18 +545,18 @@ void FileFilterIndex::manageGenreEntryInIndex(FileData* game, bool remove)
 
 	manageIndexEntry(&genreIndexAllKeys, key, remove);
 
-	key = getIndexableKey(game, GENRE_FILTER, true);
+	key = keys.keys[GENRE_FILTER][1];
 	if (!includeUnknown && key == UNKNOWN_LABEL)
 	{
 		manageIndexEntry(&genreIndexAllKeys, key, remove);
 	}
 }
 
-void FileFilterIndex::managePlayerEntryInIndex(FileData* game, bool remove)
+void FileFilterIndex::managePlayerEntryInIndex(const IndexKeys& keys, bool remove)
 {
 	// flag for including unknowns
 	bool includeUnknown = INCLUDE_UNKNOWN;
-	std::string key = getIndexableKey(game, PLAYER_FILTER, false);
+	std::string key = keys.keys[PLAYER_FILTER][0];
 
 	// only add unknown in pubdev IF both dev and pub are empty
 	if (!includeUnknown && key == UNKNOWN_LABEL) {
@@ -406,10 +567,10 @@ void FileFilterIndex::managePlayerEntryInIndex(FileData* game, bool remove)
 	manageIndexEntry(&playersIndexAllKeys, key, remove);
 }
 
-void FileFilterIndex::managePubDevEntryInIndex(FileData* game, bool remove)
+void FileFilterIndex::managePubDevEntryInIndex(const IndexKeys& keys, bool remove)
 {
-	std::string pub = getIndexableKey(game, PUBDEV_FILTER, false);
-	std::string dev = getIndexableKey(game, PUBDEV_FILTER, true);
+	std::string pub = keys.keys[PUBDEV_FILTER][0];
+	std::string dev = keys.keys[PUBDEV_FILTER][1];
 
 	// flag for including unknowns
 	bool includeUnknown = INCLUDE_UNKNOWN;
@@ -445,9 +606,9 @@ void FileFilterIndex::managePubDevEntryInIndex(FileData* game, bool remove)
 	}
 }
 
-void FileFilterIndex::manageRatingsEntryInIndex(FileData* game, bool remove)
+void FileFilterIndex::manageRatingsEntryInIndex(const IndexKeys& keys, bool remove)
 {
-	std::string key = getIndexableKey(game, RATINGS_FILTER, false);
+	std::string key = keys.keys[RATINGS_FILTER][0];
 
 	// flag for including unknowns
 	bool includeUnknown = INCLUDE_UNKNOWN;
@@ -460,11 +621,11 @@ void FileFilterIndex::manageRatingsEntryInIndex(FileData* game, bool remove)
 	manageIndexEntry(&ratingsIndexAllKeys, key, remove);
 }
 
-void FileFilterIndex::manageFavoritesEntryInIndex(FileData* game, bool remove)
+void FileFilterIndex::manageFavoritesEntryInIndex(const IndexKeys& keys, bool remove)
 {
 	// flag for including unknowns
 	bool includeUnknown = INCLUDE_UNKNOWN;
-	std::string key = getIndexableKey(game, FAVORITES_FILTER, false);
+	std::string key = keys.keys[FAVORITES_FILTER][0];
 	if (!includeUnknown && key == UNKNOWN_LABEL) {
 		// no valid favorites info found
 		return;
@@ -473,11 +634,11 @@ void FileFilterIndex::manageFavoritesEntryInIndex(FileData* game, bool remove)
 	manageIndexEntry(&favoritesIndexAllKeys, key, remove);
 }
 
-void FileFilterIndex::manageHiddenEntryInIndex(FileData* game, bool remove)
+void FileFilterIndex::manageHiddenEntryInIndex(const IndexKeys& keys, bool remove)
 {
 	// flag for including unknowns
 	bool includeUnknown = INCLUDE_UNKNOWN;
-	std::string key = getIndexableKey(game, HIDDEN_FILTER, false);
+	std::string key = keys.keys[HIDDEN_FILTER][0];
 	if (!includeUnknown && key == UNKNOWN_LABEL) {
 		// no valid hidden info found
 		return;
@@ -486,11 +647,11 @@ void FileFilterIndex::manageHiddenEntryInIndex(FileData* game, bool remove)
 	manageIndexEntry(&hiddenIndexAllKeys, key, remove);
 }
 
-void FileFilterIndex::manageKidGameEntryInIndex(FileData* game, bool remove)
+void FileFilterIndex::manageKidGameEntryInIndex(const IndexKeys& keys, bool remove)
 {
 	// flag for including unknowns
 	bool includeUnknown = INCLUDE_UNKNOWN;
-	std::string key = getIndexableKey(game, KIDGAME_FILTER, false);
+	std::string key = keys.keys[KIDGAME_FILTER][0];
 	if (!includeUnknown && key == UNKNOWN_LABEL) {
 		// no valid kidgame info found
 		return;
@@ -532,7 +693,7 @@ void FileFilterIndex::manageIndexEntry(std::map<std::string, int>* index, std::s
 	}
 }
 
-void FileFilterIndex::clearIndex(std::map<std::string, int> indexMap)
+void FileFilterIndex::clearIndex(std::map<std::string, int>& indexMap)
 {
 	indexMap.clear();
 }
@@ -3,6 +3,9 @@
 #define ES_APP_FILE_FILTER_INDEX_H
 
 #include <map>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class FileData;
@@ -16,7 +19,9 @@ enum FilterIndexType
 	RATINGS_FILTER,
 	FAVORITES_FILTER,
 	HIDDEN_FILTER,
-	KIDGAME_FILTER
+	KIDGAME_FILTER,
+
+	FILTER_TYPE_COUNT
 };
 
 struct FilterDataDecl
@@ -36,6 +41,8 @@ class FileFilterIndex
 public:
 	FileFilterIndex();
 	~FileFilterIndex();
+	// showFile() answers from what a game was indexed with, so whoever changes a filtered field (genre, players,
+	// publisher, developer, rating, favorite, hidden, kidgame) of an indexed game has to add it again afterwards
 	void addToIndex(FileData* game);
 	void removeFromIndex(FileData* game);
 	void setFilter(FilterIndexType type, std::vector<std::string>* values);
@@ -46,26 +53,43 @@ public:
 	bool isKeyBeingFilteredBy(std::string key, FilterIndexType type);
 	std::vector<FilterDataDecl>& getFilterDataDecls();
 
+	// Bumped whenever showFile() may answer differently, i.e. when the filters or the indexed games changed.
+	inline unsigned int getVersion() const { return mVersion; }
+
 	void importIndex(FileFilterIndex* indexToImport);
 	void resetIndex();
 	void resetFilters();
 	void setUIModeFilters();
 
 private:
+	typedef std::vector<uint64_t> Bitset;
+
 	std::vector<FilterDataDecl> filterDataDecl;
 	std::string getIndexableKey(FileData* game, FilterIndexType type, bool getSecondary);
 
-	void manageGenreEntryInIndex(FileData* game, bool remove = false);
-	void managePlayerEntryInIndex(FileData* game, bool remove = false);
-	void managePubDevEntryInIndex(FileData* game, bool remove = false);
-	void manageRatingsEntryInIndex(FileData* game, bool remove = false);
-	void manageFavoritesEntryInIndex(FileData* game, bool remove = false);
-	void manageHiddenEntryInIndex(FileData* game, bool remove = false);
-	void manageKidGameEntryInIndex(FileData* game, bool remove = false);
+	// the primary and secondary key of every filter type, as getIndexableKey() returns them
+	struct IndexKeys
+	{
+		std::string keys[FILTER_TYPE_COUNT][2];
+	};
+
+	bool matchesFilters(FileData* game);
+	void getIndexKeys(FileData* game, IndexKeys& keys);
+	void updateFilterResult();
+	void filtersChanged();
+
+	void manageEntriesInIndex(const IndexKeys& keys, bool remove);
+	void manageGenreEntryInIndex(const IndexKeys& keys, bool remove = false);
+	void managePlayerEntryInIndex(const IndexKeys& keys, bool remove = false);
+	void managePubDevEntryInIndex(const IndexKeys& keys, bool remove = false);
+	void manageRatingsEntryInIndex(const IndexKeys& keys, bool remove = false);
+	void manageFavoritesEntryInIndex(const IndexKeys& keys, bool remove = false);
+	void manageHiddenEntryInIndex(const IndexKeys& keys, bool remove = false);
+	void manageKidGameEntryInIndex(const IndexKeys& keys, bool remove = false);
 
 	void manageIndexEntry(std::map<std::string, int>* index, std::string key, bool remove);
 
-	void clearIndex(std::map<std::string, int> indexMap);
+	void clearIndex(std::map<std::string, int>& indexMap);
 
 	bool filterByGenre;
 	bool filterByPlayers;
@@ -93,6 +117,27 @@ private:
 
 	FileData* mRootFolder;
 
+	// inverted index: every indexed game gets a bit, every key of every filter type a set of the games it matches
+	typedef std::map<std::string, Bitset>::value_type Posting;
+
+	// a game keeps the postings it was added to, so it is taken out of the right ones after its metadata changed
+	struct IndexedGame
+	{
+		size_t id;
+		Posting* postings[FILTER_TYPE_COUNT][2]; // primary and secondary key, NULL if unknown
+	};
+
+	std::unordered_map<FileData*, IndexedGame> mGameIds;
+	std::vector<size_t> mFreeGameIds;
+	size_t mGameIdCount;
+	Bitset mIndexedGames;
+	std::map<std::string, Bitset> mPostings[FILTER_TYPE_COUNT];
+
+	// games passing all current filters, rebuilt on demand
+	Bitset mFilterResult;
+	bool mFilterResultDirty;
+	unsigned int mVersion;
+
 };
 
 #endif // ES_APP_FILE_FILTER_INDEX_H
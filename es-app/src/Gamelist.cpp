@@ -3,10 +3,19 @@
 #include "utils/FileSystemUtil.h"
 #include "FileData.h"
 #include "FileFilterIndex.h"
+#include "GamelistCache.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Settings.h"
 #include "SystemData.h"
 #include <pugixml/src/pugixml.hpp>
+#include <SDL_timer.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType type)
 {
@@ -81,6 +90,8 @@ FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType
 
 void parseGamelist(SystemData* system)
 {
+	PROFILE_SCOPE("parseGamelist");
+
 	bool trustGamelist = Settings::getInstance()->getBool("ParseGamelistOnly");
 	std::string xmlpath = system->getGamelistPath(false);
 
@@ -143,18 +154,65 @@ void parseGamelist(SystemData* system)
 		}
 	}
 }
+// everything the writer needs to know about a changed file, copied so the file itself can change or go away meanwhile
+struct GamelistEntry
+{
+	GamelistEntry(const FileData* file) : tagIndex(file->getType() == GAME ? 0 : 1), path(file->getPath()), metadata(file->metadata), displayName(file->getDisplayName()) { }
+
+	int tagIndex;
+	std::string path;
+	MetaDataList metadata;
+	std::string displayName;
+};
+
+typedef std::vector<GamelistEntry> GamelistEntries;
+
+// the entries of saves that failed, by gamelist, so the next save of the system writes them as well. A file's changed
+// flag is reset once it is in a snapshot, it wouldn't be picked up again otherwise
+static std::mutex sUnsavedMutex;
+static std::map<std::string, GamelistEntries> sUnsavedEntries;
+
+// Adds the entries in from that aren't in to, entries already in to are the more recent ones
+static void mergeEntries(GamelistEntries& to, const GamelistEntries& from)
+{
+	std::unordered_set<std::string> paths;
+	for(auto it = to.cbegin(); it != to.cend(); ++it)
+		paths.insert(it->path);
+
+	for(auto it = from.cbegin(); it != from.cend(); ++it)
+	{
+		if(paths.find(it->path) == paths.cend())
+			to.push_back(*it);
+	}
+}
 
-void addFileDataNode(pugi::xml_node& parent, const FileData* file, const char* tag, SystemData* system)
+// Removes the entries that were just written, by path
+static void removeEntries(GamelistEntries& entries, const GamelistEntries& written)
+{
+	std::unordered_set<std::string> paths;
+	for(auto it = written.cbegin(); it != written.cend(); ++it)
+		paths.insert(it->path);
+
+	GamelistEntries remaining;
+	for(auto it = entries.cbegin(); it != entries.cend(); ++it)
+	{
+		if(paths.find(it->path) == paths.cend())
+			remaining.push_back(*it);
+	}
+	entries.swap(remaining);
+}
+
+void addFileDataNode(pugi::xml_node& parent, const GamelistEntry& entry, const char* tag, const std::string& startPath)
 {
 	//create game and add to parent node
 	pugi::xml_node newNode = parent.append_child(tag);
 
 	//write metadata
-	file->metadata.appendToXML(newNode, true, system->getStartPath());
+	entry.metadata.appendToXML(newNode, true, startPath);
 
 	if(newNode.children().begin() == newNode.child("name") //first element is name
 		&& ++newNode.children().begin() == newNode.children().end() //theres only one element
-		&& newNode.child("name").text().get() == file->getDisplayName()) //the name is the default
+		&& newNode.child("name").text().get() == entry.displayName) //the name is the default
 	{
 		//if the only info is the default name, don't bother with this node
 		//delete it and ultimately do nothing
@@ -163,23 +221,21 @@ void addFileDataNode(pugi::xml_node& parent, const FileData* file, const char* t
 		//there's something useful in there so we'll keep the node, add the path
 
 		// try and make the path relative if we can so things still work if we change the rom folder location in the future
-		newNode.prepend_child("path").text().set(Utils::FileSystem::createRelativePath(file->getPath(), system->getStartPath(), false).c_str());
+		newNode.prepend_child("path").text().set(Utils::FileSystem::createRelativePath(entry.path, startPath, false).c_str());
 	}
 }
 
-void updateGamelist(SystemData* system)
+// Returns false if the gamelist couldn't be read or written
+static bool writeGamelist(const std::string& systemName, const std::string& startPath, const std::string& xmlReadPath, const std::string& xmlWritePath,
+                          const GamelistEntries& entries, const size_t fileCount, const std::function<void()>& saveCache)
 {
 	//We do this by reading the XML again, adding changes and then writing it back,
 	//because there might be information missing in our systemdata which would then miss in the new XML.
 	//We have the complete information for every game though, so we can simply remove a game
 	//we already have in the system from the XML, and then add it back from its GameData information...
 
-	if(Settings::getInstance()->getBool("IgnoreGamelist"))
-		return;
-
 	pugi::xml_document doc;
 	pugi::xml_node root;
-	std::string xmlReadPath = system->getGamelistPath(false);
 
 	if(Utils::FileSystem::exists(xmlReadPath))
 	{
@@ -189,85 +245,208 @@ void updateGamelist(SystemData* system)
 		if(!result)
 		{
 			LOG(LogError) << "Error parsing XML file \"" << xmlReadPath << "\"!\n	" << result.description();
-			return;
+			return false;
 		}
 
 		root = doc.child("gameList");
 		if(!root)
 		{
 			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlReadPath << "\"!";
-			return;
+			return false;
 		}
 	}else{
 		//set up an empty gamelist to append to
 		root = doc.append_child("gameList");
 	}
 
+	//now we have all the information from the XML. now iterate through all our changed games and add information from there
+	int numUpdated = 0;
+	const unsigned int startTime = SDL_GetTicks();
 
-	//now we have all the information from the XML. now iterate through all our games and add information from there
-	FileData* rootFolder = system->getRootFolder();
-	if (rootFolder != nullptr)
-	{
-		int numUpdated = 0;
+	// index the existing nodes by their resolved path, so looking a file up doesn't have to walk the whole document
+	const char* tagList[2] = { "game", "folder" };
+	std::unordered_map<std::string, pugi::xml_node> nodesByPath[2];
+	std::unordered_map<std::string, pugi::xml_node> nodesByCanonicalPath[2];
+	bool canonicalIndexed[2] = { false, false };
+	std::set<pugi::xml_node> replacedNodes;
 
-		//get only files, no folders
-		std::vector<FileData*> files = rootFolder->getFilesRecursive(GAME | FOLDER);
-		//iterate through all files, checking if they're already in the XML
-		for(std::vector<FileData*>::const_iterator fit = files.cbegin(); fit != files.cend(); ++fit)
+	for(int i = 0; i < 2; i++)
+	{
+		for(pugi::xml_node fileNode = root.child(tagList[i]); fileNode; fileNode = fileNode.next_sibling(tagList[i]))
 		{
-			const char* tag = ((*fit)->getType() == GAME) ? "game" : "folder";
-
-			// check if current file has metadata, if no, skip it as it wont be in the gamelist anyway.
-			if ((*fit)->metadata.isDefault()) {
+			pugi::xml_node pathNode = fileNode.child("path");
+			if(!pathNode)
+			{
+				LOG(LogError) << "<" << tagList[i] << "> node contains no <path> child!";
 				continue;
 			}
 
-			// do not touch if it wasn't changed anyway
-			if (!(*fit)->metadata.wasChanged())
-				continue;
-
-			// check if the file already exists in the XML
-			// if it does, remove it before adding
-			for(pugi::xml_node fileNode = root.child(tag); fileNode; fileNode = fileNode.next_sibling(tag))
+			// parseGamelist() loads the last node for a path, the ones before it are dropped
+			pugi::xml_node& indexed = nodesByPath[i][Utils::FileSystem::resolveRelativePath(pathNode.text().get(), startPath, true)];
+			if(indexed)
 			{
-				pugi::xml_node pathNode = fileNode.child("path");
-				if(!pathNode)
-				{
-					LOG(LogError) << "<" << tag << "> node contains no <path> child!";
-					continue;
-				}
+				LOG(LogWarning) << "Removing duplicate <" << tagList[i] << "> node for \"" << pathNode.text().get() << "\"";
+				replacedNodes.insert(indexed);
+			}
+			indexed = fileNode;
+		}
+	}
+
+	//iterate through all changed files, checking if they're already in the XML
+	for(auto it = entries.cbegin(); it != entries.cend(); ++it)
+	{
+		// check if the file already exists in the XML
+		// if it does, remove it before adding
+		const int tagIndex = it->tagIndex;
+		const std::string& gamePath = it->path;
 
-				std::string nodePath = Utils::FileSystem::resolveRelativePath(pathNode.text().get(), system->getStartPath(), true);
-				std::string gamePath = (*fit)->getPath();
-				if(nodePath == gamePath || (Utils::FileSystem::exists(nodePath) &&
-				                            Utils::FileSystem::exists(gamePath) &&
-				                            Utils::FileSystem::isEquivalent(nodePath, gamePath)))
+		auto nodeIt = nodesByPath[tagIndex].find(gamePath);
+		if(nodeIt != nodesByPath[tagIndex].cend())
+		{
+			// found it
+			replacedNodes.insert(nodeIt->second);
+		}
+		else if(Utils::FileSystem::exists(gamePath))
+		{
+			// the node may still refer to the same file through another path, fall back to comparing canonical paths
+			// those cost a few filesystem calls per node, so they are only indexed once something isn't found by path
+			if(!canonicalIndexed[tagIndex])
+			{
+				for(auto pathIt = nodesByPath[tagIndex].cbegin(); pathIt != nodesByPath[tagIndex].cend(); ++pathIt)
 				{
-					// found it
-					root.remove_child(fileNode);
-					break;
+					if(Utils::FileSystem::exists(pathIt->first))
+						nodesByCanonicalPath[tagIndex][Utils::FileSystem::getCanonicalPath(pathIt->first)] = pathIt->second;
 				}
+				canonicalIndexed[tagIndex] = true;
 			}
 
-			// it was either removed or never existed to begin with; either way, we can add it now
-			addFileDataNode(root, *fit, tag, system);
-			++numUpdated;
+			auto canonicalIt = nodesByCanonicalPath[tagIndex].find(Utils::FileSystem::getCanonicalPath(gamePath));
+			if(canonicalIt != nodesByCanonicalPath[tagIndex].cend())
+			{
+				// found it
+				replacedNodes.insert(canonicalIt->second);
+			}
 		}
 
-		//now write the file
+		// the old node, if any, is removed below; either way, we can add it now
+		addFileDataNode(root, *it, tagList[tagIndex], startPath);
+		++numUpdated;
+	}
+
+	// removed last so the indexes above never hold a node that no longer exists
+	for(auto it = replacedNodes.cbegin(); it != replacedNodes.cend(); ++it)
+		root.remove_child(*it);
 
-		if (numUpdated > 0) {
-			//make sure the folders leading up to this path exist (or the write will fail)
-			std::string xmlWritePath(system->getGamelistPath(true));
-			Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
+	//now write the file
 
-			LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << xmlReadPath << "'";
+	if (numUpdated > 0) {
+		//make sure the folders leading up to this path exist (or the write will fail)
+		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
 
-			if (!doc.save_file(xmlWritePath.c_str())) {
-				LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
-			}
+		LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << xmlReadPath << "'";
+
+		// write to a temporary file first and swap it in, so an interrupted save never leaves a truncated gamelist behind
+		const std::string xmlTempPath = xmlWritePath + ".tmp";
+		if (!doc.save_file(xmlTempPath.c_str()) || !Utils::FileSystem::renameFile(xmlTempPath, xmlWritePath)) {
+			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << systemName << ")!";
+			Utils::FileSystem::removeFile(xmlTempPath);
+			return false;
 		}
-	}else{
+
+		if (saveCache) {
+			// the old snapshot no longer matches the gamelist we just wrote
+			saveCache();
+		}
+
+		LOG(LogInfo) << "Saved gamelist for system " << systemName << " (" << fileCount << " entities) in " << (SDL_GetTicks() - startTime) << "ms";
+	}
+
+	return true;
+}
+
+std::function<void()> prepareGamelistUpdate(SystemData* system)
+{
+	if(Settings::getInstance()->getBool("IgnoreGamelist"))
+		return std::function<void()>();
+
+	FileData* rootFolder = system->getRootFolder();
+	if (rootFolder == nullptr)
+	{
 		LOG(LogError) << "Found no root folder for system \"" << system->getName() << "\"!";
+		return std::function<void()>();
+	}
+
+	//get only files, no folders
+	std::vector<FileData*> files = rootFolder->getFilesRecursive(GAME | FOLDER);
+	std::shared_ptr<GamelistEntries> entries = std::make_shared<GamelistEntries>();
+
+	for(std::vector<FileData*>::const_iterator fit = files.cbegin(); fit != files.cend(); ++fit)
+	{
+		// check if current file has metadata, if no, skip it as it wont be in the gamelist anyway.
+		if ((*fit)->metadata.isDefault()) {
+			continue;
+		}
+
+		// do not touch if it wasn't changed anyway
+		if (!(*fit)->metadata.wasChanged())
+			continue;
+
+		// from now on it's up to this snapshot, so the next save only picks up what changed after it
+		entries->push_back(GamelistEntry(*fit));
+		(*fit)->metadata.resetChangedFlag();
 	}
+
+	const std::string xmlWritePath = system->getGamelistPath(true);
+
+	{
+		std::unique_lock<std::mutex> lock(sUnsavedMutex);
+		auto it = sUnsavedEntries.find(xmlWritePath);
+		if(it != sUnsavedEntries.cend())
+		{
+			mergeEntries(*entries, it->second);
+			sUnsavedEntries.erase(it);
+		}
+	}
+
+	if(entries->empty())
+		return std::function<void()>();
+
+	// everything the job needs, settings included, is read here on the main thread
+	const std::string systemName = system->getName();
+	const std::string startPath = system->getStartPath();
+	const std::string xmlReadPath = system->getGamelistPath(false);
+	const size_t fileCount = files.size();
+	const std::function<void()> saveCache = Settings::getInstance()->getBool("GamelistCache") ? prepareGamelistCacheSave(system) : std::function<void()>();
+
+	return [systemName, startPath, xmlReadPath, xmlWritePath, entries, fileCount, saveCache]
+	{
+		const bool written = writeGamelist(systemName, startPath, xmlReadPath, xmlWritePath, *entries, fileCount, saveCache);
+
+		std::unique_lock<std::mutex> lock(sUnsavedMutex);
+		auto it = sUnsavedEntries.find(xmlWritePath);
+		if(written)
+		{
+			// a save that failed before this one ran may hold older versions of what was just written
+			if(it != sUnsavedEntries.cend())
+			{
+				removeEntries(it->second, *entries);
+				if(it->second.empty())
+					sUnsavedEntries.erase(it);
+			}
+		}
+		else
+		{
+			GamelistEntries unsaved = *entries;
+			if(it != sUnsavedEntries.cend())
+				mergeEntries(unsaved, it->second);
+			sUnsavedEntries[xmlWritePath] = unsaved;
+		}
+	};
+}
+
+void updateGamelist(SystemData* system)
+{
+	const std::function<void()> job = prepareGamelistUpdate(system);
+	if(job)
+		job();
 }
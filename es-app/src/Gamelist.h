@@ -2,6 +2,8 @@
 #ifndef ES_APP_GAME_LIST_H
 #define ES_APP_GAME_LIST_H
 
+#include <functional>
+
 class SystemData;
 
 // Loads gamelist.xml data into a SystemData.
@@ -10,4 +12,10 @@ void parseGamelist(SystemData* system);
 // Writes currently loaded metadata for a SystemData to gamelist.xml.
 void updateGamelist(SystemData* system);
 
+// Takes a snapshot of the changed metadata for a SystemData and returns the job that merges it into gamelist.xml.
+// The snapshot must be taken on the main thread, the job can run on any thread. Returns an empty job if nothing changed.
+// Files in the snapshot count as unchanged from then on, jobs have to run in the order they were prepared in. What a
+// failed job didn't write goes into the next snapshot of the system.
+std::function<void()> prepareGamelistUpdate(SystemData* system);
+
 #endif // ES_APP_GAME_LIST_H
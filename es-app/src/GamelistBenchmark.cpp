@@ -0,0 +1,118 @@
+#include "GamelistBenchmark.h"
+
+#include "utils/FileSystemUtil.h"
+#include "FileData.h"
+#include "Gamelist.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <pugixml/src/pugixml.hpp>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+
+static const unsigned int GAME_COUNT = 30000;
+static const unsigned int FEW_COUNT  = 10; // games changed in the "few" phase, spread over the whole list
+static const int RUNS                = 5;
+
+static bool writeGamelist(const std::string& path)
+{
+	pugi::xml_document doc;
+	pugi::xml_node root = doc.append_child("gameList");
+
+	for(unsigned int i = 0; i < GAME_COUNT; i++)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "Game %05u", i);
+
+		// about what a scraper fills in
+		pugi::xml_node game = root.append_child("game");
+		game.append_child("path").text().set((std::string("./") + name + ".zip").c_str());
+		game.append_child("name").text().set(name);
+		game.append_child("desc").text().set((std::string(name) + " is a game. It has a description about as long as the ones the scrapers "
+			"bring in, which is a couple of sentences telling what the game is about and who made it.").c_str());
+		game.append_child("image").text().set((std::string("./images/") + name + "-image.png").c_str());
+		game.append_child("rating").text().set("0.8");
+		game.append_child("releasedate").text().set("19920101T000000");
+		game.append_child("developer").text().set("Developer");
+		game.append_child("publisher").text().set("Publisher");
+		game.append_child("genre").text().set("Platform");
+		game.append_child("players").text().set("2");
+	}
+
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(path));
+	return doc.save_file(path.c_str());
+}
+
+// Saves the gamelist RUNS times, with every step-th game changed before each save, and logs the times
+static void runPhase(SystemData* system, const std::string& phase, const std::vector<FileData*>& games, size_t step)
+{
+	long long total = 0;
+	long long best = -1;
+
+	for(int run = 0; run < RUNS; run++)
+	{
+		// a value that differs from the last run, so every picked game really is changed
+		for(size_t i = 0; i < games.size(); i += step)
+			games[i]->metadata.set("playcount", std::to_string(run + 1));
+
+		const auto start = std::chrono::steady_clock::now();
+		updateGamelist(system);
+		const auto end = std::chrono::steady_clock::now();
+
+		const long long time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+		total += time;
+		best = (best < 0) ? time : std::min(best, time);
+	}
+
+	LOG(LogInfo) << "Gamelist benchmark \"" << phase << "\": " << ((games.size() + step - 1) / step) << " of " << games.size() <<
+		" games changed, " << (total / RUNS / 1000) << "ms avg, " << (best / 1000) << "ms best of " << RUNS << " saves";
+}
+
+int runGamelistBenchmark(const std::string& folder)
+{
+	const std::string startPath = Utils::FileSystem::getGenericPath(Utils::FileSystem::getAbsolutePath(folder));
+	if(!writeGamelist(startPath + "/gamelist.xml"))
+	{
+		LOG(LogError) << "Could not write the benchmark gamelist to \"" << startPath << "\"";
+		return 1;
+	}
+
+	// only the gamelist is read and written, nothing is scanned or cached
+	Settings* settings = Settings::getInstance();
+	const bool parseGamelistOnly = settings->getBool("ParseGamelistOnly");
+	const bool ignoreGamelist = settings->getBool("IgnoreGamelist");
+	const bool gamelistCache = settings->getBool("GamelistCache");
+	settings->setBool("ParseGamelistOnly", true);
+	settings->setBool("IgnoreGamelist", false);
+	settings->setBool("GamelistCache", false);
+
+	SystemEnvironmentData* envData = new SystemEnvironmentData;
+	envData->mStartPath = startPath;
+	envData->mSearchExtensions.push_back(".zip");
+
+	int exitCode = 0;
+
+	{
+		SystemData system("gamelist-benchmark", "Gamelist benchmark", envData, "");
+		const std::vector<FileData*> games = system.getRootFolder()->getFilesRecursive(GAME);
+		if(games.size() != GAME_COUNT)
+		{
+			LOG(LogError) << "Gamelist benchmark loaded " << games.size() << " games instead of " << GAME_COUNT;
+			exitCode = 1;
+		}
+		else
+		{
+			runPhase(&system, "all", games, 1);
+			runPhase(&system, "few", games, GAME_COUNT / FEW_COUNT);
+		}
+	}
+
+	delete envData;
+
+	settings->setBool("ParseGamelistOnly", parseGamelistOnly);
+	settings->setBool("IgnoreGamelist", ignoreGamelist);
+	settings->setBool("GamelistCache", gamelistCache);
+
+	return exitCode;
+}
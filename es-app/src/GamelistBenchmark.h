@@ -0,0 +1,13 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_BENCHMARK_H
+#define ES_APP_GAMELIST_BENCHMARK_H
+
+#include <string>
+
+// Writes a gamelist.xml with 30000 games into folder, loads it as a system and times saving it back: once with every
+// game changed (the end of a big scrape) and once with only a few changed (a game launched). The games don't need to
+// exist, the gamelist is trusted. Anything else in folder is left alone, its gamelist.xml is overwritten.
+// Returns the exit code for main().
+int runGamelistBenchmark(const std::string& folder);
+
+#endif // ES_APP_GAMELIST_BENCHMARK_H
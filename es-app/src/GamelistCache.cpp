@@ -0,0 +1,216 @@
+#include "GamelistCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "CacheFile.h"
+#include "FileData.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <memory>
+
+// bump this whenever the layout below changes, old snapshots are then simply ignored
+static const char     CACHE_MAGIC[4] = { 'E', 'S', 'G', 'L' };
+static const uint32_t CACHE_VERSION  = 4;
+
+// header:  magic, version, start path, extensions, flags, gamelist path/size/mtime, scanned folders (path/mtime), mtimes in ns
+// tree:    child count, then per child: type, path, metadata values in MDD order and, for folders, its own tree
+
+static std::string getCachePath(SystemData* system)
+{
+	return getCacheFilePath("gamelists/" + system->getName() + ".bin");
+}
+
+static uint8_t getCacheFlags()
+{
+	uint8_t flags = 0;
+
+	if(Settings::getInstance()->getBool("ParseGamelistOnly")) flags |= 0x01;
+	if(Settings::getInstance()->getBool("ShowHiddenFiles"))   flags |= 0x02;
+	if(Settings::getInstance()->getBool("IgnoreGamelist"))    flags |= 0x04;
+
+	return flags;
+}
+
+static std::string getExtensionList(SystemData* system)
+{
+	const std::vector<std::string>& extensions = system->getExtensions();
+	std::string list;
+
+	for(auto it = extensions.cbegin(); it != extensions.cend(); ++it)
+		list += *it + " ";
+
+	return list;
+}
+
+static void writeChildren(CacheWriter& writer, const FileData* folder)
+{
+	const std::vector<FileData*>& children = folder->getChildren();
+	writer.write((uint32_t)children.size());
+
+	for(auto it = children.cbegin(); it != children.cend(); ++it)
+	{
+		const FileData* file = *it;
+		writer.write((uint8_t)file->getType());
+		writer.writeString(file->getPath());
+
+		const std::vector<MetaDataDecl>& mdd = file->metadata.getMDD();
+		writer.write((uint32_t)mdd.size());
+		for(size_t i = 0; i < mdd.size(); i++)
+			writer.writeString(file->metadata.get(getMetaDataId(file->metadata.getType(), i)));
+
+		if(file->getType() == FOLDER)
+			writeChildren(writer, file);
+	}
+}
+
+// with a NULL folder the tree is only validated, so nothing has to be torn down if the snapshot turns out to be broken
+static bool readChildren(CacheReader& reader, SystemData* system, FileData* folder)
+{
+	uint32_t count;
+	if(!reader.read(&count))
+		return false;
+
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint8_t type;
+		std::string path;
+		if(!reader.read(&type) || (type != GAME && type != FOLDER) || !reader.readString(folder ? &path : NULL))
+			return false;
+
+		const std::vector<MetaDataDecl>& mdd = getMDDByType(type == GAME ? GAME_METADATA : FOLDER_METADATA);
+		uint32_t mddCount;
+		if(!reader.read(&mddCount) || mddCount != mdd.size())
+			return false;
+
+		FileData* file = folder ? new FileData((FileType)type, path, system->getSystemEnvData(), system) : NULL;
+
+		for(size_t i = 0; i < mdd.size(); i++)
+		{
+			std::string value;
+			if(!reader.readString(file ? &value : NULL))
+				return false;
+
+			if(file)
+				file->metadata.set(getMetaDataId(file->metadata.getType(), i), value);
+		}
+
+		if(type == FOLDER && !readChildren(reader, system, file))
+			return false;
+
+		if(file)
+		{
+			file->metadata.resetChangedFlag();
+			folder->addChild(file);
+		}
+	}
+
+	return true;
+}
+
+bool loadGamelistCache(SystemData* system)
+{
+	const std::string cachePath = getCachePath(system);
+
+	CacheReader reader;
+	if(!reader.load(cachePath, CACHE_MAGIC, CACHE_VERSION))
+		return false;
+
+	std::string startPath;
+	std::string extensions;
+	uint8_t flags;
+	if(!reader.readString(&startPath) || startPath != system->getStartPath() ||
+	   !reader.readString(&extensions) || extensions != getExtensionList(system) ||
+	   !reader.read(&flags) || flags != getCacheFlags())
+		return false;
+
+	const std::string gamelistPath = system->getGamelistPath(false);
+	std::string cachedGamelistPath;
+	int64_t gamelistSize;
+	int64_t gamelistTime;
+	if(!reader.readString(&cachedGamelistPath) || cachedGamelistPath != gamelistPath ||
+	   !reader.read(&gamelistSize) || gamelistSize != (int64_t)Utils::FileSystem::getFileSize(gamelistPath) ||
+	   !reader.read(&gamelistTime) || gamelistTime != (int64_t)Utils::FileSystem::getModifiedTimeNs(gamelistPath))
+	{
+		LOG(LogInfo) << "Gamelist for system \"" << system->getName() << "\" changed, ignoring its cache";
+		return false;
+	}
+
+	uint32_t folderCount;
+	if(!reader.read(&folderCount))
+		return false;
+
+	SystemData::FolderTimes folders;
+	folders.reserve(folderCount);
+	for(uint32_t i = 0; i < folderCount; i++)
+	{
+		std::string path;
+		int64_t time;
+		if(!reader.readString(&path) || !reader.read(&time))
+			return false;
+
+		if(time != (int64_t)Utils::FileSystem::getModifiedTimeNs(path))
+		{
+			LOG(LogInfo) << "Folder \"" << path << "\" changed, ignoring gamelist cache for system \"" << system->getName() << "\"";
+			return false;
+		}
+
+		folders.push_back(std::make_pair(path, (long long)time));
+	}
+
+	const size_t treePos = reader.getPos();
+	if(!readChildren(reader, system, NULL) || !reader.atEnd())
+	{
+		LOG(LogWarning) << "Gamelist cache \"" << cachePath << "\" is corrupt, ignoring it";
+		return false;
+	}
+
+	reader.setPos(treePos);
+	readChildren(reader, system, system->getRootFolder());
+	system->setScannedFolders(folders);
+
+	LOG(LogInfo) << "Loaded system \"" << system->getName() << "\" from gamelist cache";
+	return true;
+}
+
+std::function<void()> prepareGamelistCacheSave(SystemData* system)
+{
+	// the tree is serialized right away, the header needs the size and mtime of the gamelist as it is once the job runs
+	std::shared_ptr<CacheWriter> tree = std::make_shared<CacheWriter>();
+
+	const SystemData::FolderTimes& folders = system->getScannedFolders();
+	tree->write((uint32_t)folders.size());
+	for(auto it = folders.cbegin(); it != folders.cend(); ++it)
+	{
+		tree->writeString(it->first);
+		tree->write((int64_t)it->second);
+	}
+
+	writeChildren(*tree, system->getRootFolder());
+
+	const std::string startPath = system->getStartPath();
+	const std::string extensions = getExtensionList(system);
+	const uint8_t flags = getCacheFlags();
+	const std::string gamelistPath = system->getGamelistPath(false);
+	const std::string cachePath = getCachePath(system);
+
+	return [tree, startPath, extensions, flags, gamelistPath, cachePath]
+	{
+		CacheWriter writer(CACHE_MAGIC, CACHE_VERSION);
+
+		writer.writeString(startPath);
+		writer.writeString(extensions);
+		writer.write(flags);
+
+		writer.writeString(gamelistPath);
+		writer.write((int64_t)Utils::FileSystem::getFileSize(gamelistPath));
+		writer.write((int64_t)Utils::FileSystem::getModifiedTimeNs(gamelistPath));
+
+		writer.append(*tree);
+		writer.save(cachePath);
+	};
+}
+
+void saveGamelistCache(SystemData* system)
+{
+	prepareGamelistCacheSave(system)();
+}
@@ -0,0 +1,21 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_CACHE_H
+#define ES_APP_GAMELIST_CACHE_H
+
+#include <functional>
+
+class SystemData;
+
+// Binary snapshot of a system's FileData tree and metadata, stored in ~/.emulationstation/cache/gamelists/.
+// It is only used while gamelist.xml and every scanned ROM directory still match the snapshot.
+
+// Fills the (empty) root folder of a SystemData from its snapshot. Returns false if there is no fresh snapshot.
+bool loadGamelistCache(SystemData* system);
+
+// Writes a snapshot of the currently loaded tree and metadata for a SystemData.
+void saveGamelistCache(SystemData* system);
+
+// Serializes the tree on the calling (main) thread and returns the job that writes the snapshot, which can run on any thread.
+std::function<void()> prepareGamelistCacheSave(SystemData* system);
+
+#endif // ES_APP_GAMELIST_CACHE_H
@@ -0,0 +1,159 @@
+#include "GamelistWriter.h"
+
+#include "Gamelist.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <SDL_timer.h>
+#include <algorithm>
+
+// a system is saved once it stayed unchanged for DEBOUNCE_MS, but never later than MAX_DELAY_MS after its first change
+#define DEBOUNCE_MS  2000
+#define MAX_DELAY_MS 10000
+
+GamelistWriter* GamelistWriter::sInstance = NULL;
+
+GamelistWriter* GamelistWriter::getInstance()
+{
+	if(!sInstance)
+		sInstance = new GamelistWriter();
+
+	return sInstance;
+}
+
+void GamelistWriter::deinit()
+{
+	if(sInstance)
+	{
+		delete sInstance;
+		sInstance = NULL;
+	}
+}
+
+GamelistWriter::GamelistWriter() : mBusy(false), mExit(false)
+{
+	mThread = std::thread(&GamelistWriter::threadProc, this);
+}
+
+GamelistWriter::~GamelistWriter()
+{
+	// nothing that was queued is dropped, metadata edits are only ever in these saves
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mExit = true;
+	}
+	mEvent.notify_one();
+	mThread.join();
+}
+
+void GamelistWriter::markDirty(SystemData* system, bool always)
+{
+	// runtime changes are only written by users that let ES write their gamelists in the first place
+	if(Settings::getInstance()->getBool("IgnoreGamelist") || (!always && !Settings::getInstance()->getBool("SaveGamelistsOnExit")) || system->isCollection())
+		return;
+
+	const unsigned int now = SDL_GetTicks();
+	auto it = mDirtySystems.find(system);
+	if(it == mDirtySystems.cend())
+	{
+		DirtySystem& dirty = mDirtySystems[system];
+		dirty.firstChange = now;
+		dirty.lastChange = now;
+	}else{
+		it->second.lastChange = now;
+	}
+}
+
+void GamelistWriter::update()
+{
+	if(mDirtySystems.empty())
+		return;
+
+	const unsigned int now = SDL_GetTicks();
+	for(auto it = mDirtySystems.begin(); it != mDirtySystems.end(); )
+	{
+		if(now - it->second.lastChange >= DEBOUNCE_MS || now - it->second.firstChange >= MAX_DELAY_MS)
+		{
+			SystemData* system = it->first;
+			it = mDirtySystems.erase(it);
+			save(system);
+		}else{
+			++it;
+		}
+	}
+}
+
+int GamelistWriter::getTimeUntilSave() const
+{
+	int time = -1;
+
+	const unsigned int now = SDL_GetTicks();
+	for(auto it = mDirtySystems.cbegin(); it != mDirtySystems.cend(); ++it)
+	{
+		const unsigned int sinceLast = now - it->second.lastChange;
+		const unsigned int sinceFirst = now - it->second.firstChange;
+		if(sinceLast >= DEBOUNCE_MS || sinceFirst >= MAX_DELAY_MS)
+			return 0;
+
+		const int systemTime = (int)std::min(DEBOUNCE_MS - sinceLast, MAX_DELAY_MS - sinceFirst);
+		if(time < 0 || systemTime < time)
+			time = systemTime;
+	}
+
+	return time;
+}
+
+void GamelistWriter::save(SystemData* system)
+{
+	mDirtySystems.erase(system);
+
+	Job job;
+	job.name = system->getName();
+	job.write = prepareGamelistUpdate(system);
+	if(!job.write)
+		return;
+
+	// a snapshot only holds what changed since the one before, so a pending save of the system stays queued
+	std::unique_lock<std::mutex> lock(mMutex);
+	mQueue.push_back(job);
+	mEvent.notify_one();
+}
+
+void GamelistWriter::saveDirty()
+{
+	while(!mDirtySystems.empty())
+		save(mDirtySystems.begin()->first);
+}
+
+void GamelistWriter::flush()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	if(!mQueue.empty() || mBusy)
+		LOG(LogInfo) << "Waiting for " << (mQueue.size() + (mBusy ? 1 : 0)) << " gamelist save(s) to finish";
+
+	mIdleEvent.wait(lock, [this] { return mQueue.empty() && !mBusy; });
+}
+
+void GamelistWriter::threadProc()
+{
+	while(true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mBusy = false;
+			mIdleEvent.notify_all();
+			mEvent.wait(lock, [this] { return mExit || !mQueue.empty(); });
+
+			// the queue is worked off before the thread stops
+			if(mQueue.empty())
+				return;
+
+			job = mQueue.front();
+			mQueue.pop_front();
+			mBusy = true;
+		}
+
+		job.write();
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_WRITER_H
+#define ES_APP_GAMELIST_WRITER_H
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class SystemData;
+
+// Saves gamelists in the background while ES is running.
+// Systems are marked dirty whenever their metadata changes, repeated changes are coalesced and only once a system
+// stayed untouched for a little while is a snapshot of what changed since the last one taken and handed to the writer
+// thread, which writes them in order. Everything but the file work itself happens on the main thread.
+class GamelistWriter
+{
+public:
+	static GamelistWriter* getInstance();
+
+	// Waits for every queued save and stops the writer thread, called once the systems are deleted
+	static void deinit();
+
+	// Schedules a save of the system's gamelist, if runtime changes are to be saved at all. With always it is saved
+	// even if they aren't, for changes that were always written right away, like scraped metadata.
+	void markDirty(SystemData* system, bool always = false);
+
+	// Hands the systems that stayed unchanged long enough to the writer thread, called every frame.
+	void update();
+
+	// Milliseconds until update() has a system to hand over, -1 if none is dirty.
+	int getTimeUntilSave() const;
+
+	// Snapshots the system right away and queues its save.
+	void save(SystemData* system);
+
+	// Saves every system that is marked dirty right away, before the systems go away.
+	void saveDirty();
+
+	// Waits for the queued saves to finish, however long they take.
+	void flush();
+
+private:
+	GamelistWriter();
+	~GamelistWriter();
+
+	static GamelistWriter* sInstance;
+
+	struct DirtySystem
+	{
+		unsigned int firstChange;
+		unsigned int lastChange;
+	};
+
+	struct Job
+	{
+		std::string name;
+		std::function<void()> write;
+	};
+
+	void threadProc();
+
+	std::map<SystemData*, DirtySystem> mDirtySystems; // only touched from the main thread
+	std::list<Job> mQueue;
+
+	std::thread					mThread;
+	std::mutex					mMutex;
+	std::condition_variable		mEvent;
+	std::condition_variable		mIdleEvent;
+	bool						mBusy;
+	bool						mExit;
+};
+
+#endif // ES_APP_GAMELIST_WRITER_H
@@ -0,0 +1,58 @@
+#include "MediaIndex.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+
+MediaIndex::MediaIndex(const std::string& folder) : mFolder(folder), mFolderTime(0), mChecked(false)
+{
+}
+
+std::string MediaIndex::getPath(const std::string& fileName)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	refresh();
+
+	if(mFiles.find(fileName) != mFiles.cend())
+		return mFolder + "/" + fileName;
+
+	auto it = mLowerCaseFiles.find(Utils::String::toLower(fileName));
+	if(it != mLowerCaseFiles.cend())
+		return mFolder + "/" + it->second;
+
+	return "";
+}
+
+void MediaIndex::invalidate()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mChecked = false;
+}
+
+void MediaIndex::refresh()
+{
+	if(mChecked)
+		return;
+
+	mChecked = true;
+
+	// a missing folder has a 0 mtime and simply stays empty until it shows up
+	const time_t folderTime = Utils::FileSystem::getModifiedTime(mFolder);
+	if(folderTime == mFolderTime)
+		return;
+
+	mFolderTime = folderTime;
+	mFiles.clear();
+	mLowerCaseFiles.clear();
+
+	if(folderTime == 0)
+		return;
+
+	const Utils::FileSystem::stringList dirContent = Utils::FileSystem::getDirContent(mFolder);
+	for(auto it = dirContent.cbegin(); it != dirContent.cend(); ++it)
+	{
+		const std::string fileName = Utils::FileSystem::getFileName(*it);
+		mFiles.insert(fileName);
+		mLowerCaseFiles.insert(std::make_pair(Utils::String::toLower(fileName), fileName));
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#ifndef ES_APP_MEDIA_INDEX_H
+#define ES_APP_MEDIA_INDEX_H
+
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <unordered_map>
+#include <unordered_set>
+
+// The file names in a system's images/ folder, where the local image, marquee and video of a game are looked for.
+// The folder is listed on first use and looked at again only after invalidate(), when its gamelist is reloaded, so
+// looking media up while scrolling doesn't stat() anything.
+class MediaIndex
+{
+public:
+	MediaIndex(const std::string& folder);
+
+	// Returns the full path of fileName if it is in the folder, an empty string otherwise. Names that only differ in
+	// case match as well, like they do on the FAT and NTFS cards media is usually kept on.
+	std::string getPath(const std::string& fileName);
+
+	// The next lookup checks if the folder changed and lists it again if it did
+	void invalidate();
+
+private:
+	void refresh();
+
+	std::string mFolder;
+	std::unordered_set<std::string> mFiles;
+	std::unordered_map<std::string, std::string> mLowerCaseFiles; // lower cased name to the name on disk
+	time_t mFolderTime;
+	bool mChecked;
+	std::mutex mMutex;
+};
+
+#endif // ES_APP_MEDIA_INDEX_H
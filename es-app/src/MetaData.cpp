@@ -4,6 +4,9 @@
 #include "Log.h"
 #include <pugixml/src/pugixml.hpp>
 #include "Locale.h"
+#include <climits>
+#include <string.h>
+#include <unordered_map>
 
 MetaDataDecl gameDecls[] = {
   // key,         type,                   default,            statistic,  name in GuiMetaDataEd,      prompt in GuiMetaDataEd
@@ -61,14 +64,191 @@ const std::vector<MetaDataDecl>& getMDDByType(MetaDataListType type)
 
 
 
+static std::unordered_map<std::string, MetaDataId> createMetaDataIds()
+{
+	// games declare every key, in MetaDataId order
+	std::unordered_map<std::string, MetaDataId> ids;
+	for(size_t i = 0; i < gameMDD.size(); i++)
+		ids[gameMDD[i].key] = (MetaDataId)i;
+
+	return ids;
+}
+
+MetaDataId getMetaDataId(const std::string& key)
+{
+	static const std::unordered_map<std::string, MetaDataId> ids = createMetaDataIds();
+
+	auto it = ids.find(key);
+	return it != ids.cend() ? it->second : META_COUNT;
+}
+
+// The slot of every declaration of a type and the other way round, so the declarations can be in whatever order the
+// editor shows them in
+struct DeclSlots
+{
+	MetaDataId ids[META_COUNT];
+	int decls[META_COUNT]; // -1 if the type doesn't declare the field
+
+	DeclSlots(MetaDataListType type)
+	{
+		for(size_t i = 0; i < META_COUNT; i++)
+			decls[i] = -1;
+
+		const std::vector<MetaDataDecl>& mdd = getMDDByType(type);
+		for(size_t i = 0; i < mdd.size(); i++)
+		{
+			ids[i] = getMetaDataId(mdd[i].key);
+			decls[ids[i]] = (int)i;
+		}
+	}
+};
+
+static const DeclSlots& getDeclSlots(MetaDataListType type)
+{
+	static const DeclSlots gameSlots(GAME_METADATA);
+	static const DeclSlots folderSlots(FOLDER_METADATA);
+
+	return (type == GAME_METADATA) ? gameSlots : folderSlots;
+}
+
+MetaDataId getMetaDataId(MetaDataListType type, size_t index)
+{
+	return getDeclSlots(type).ids[index];
+}
+
+// digits in "%Y%m%dT%H%M%S"
+static const int DATE_DIGITS = 14;
+
+static long long parseDate(const std::string& value)
+{
+	// dates used to be sorted by comparing their ISO strings ("%Y%m%dT%H%M%S"), this number sorts the same way. A partial
+	// date like "1992" is padded to 19920000000000, before the full dates of that year, and the digit count at the end
+	// keeps it before "19920000" too, like the shorter string was
+	if(value.empty())
+		return 0;
+
+	long long date = 0;
+	int digits = 0;
+	for(auto it = value.cbegin(); it != value.cend(); ++it)
+	{
+		if(*it >= '0' && *it <= '9' && digits < DATE_DIGITS)
+		{
+			date = (date * 10) + (*it - '0');
+			digits++;
+		}
+		else if(*it != 'T')
+		{
+			return LLONG_MAX;
+		}
+	}
+
+	for(int i = digits; i < DATE_DIGITS; i++)
+		date *= 10;
+
+	return (date * (DATE_DIGITS + 1)) + digits;
+}
+
 MetaDataList::MetaDataList(MetaDataListType type)
-	: mType(type), mWasChanged(false)
+	: mType(type), mWasChanged(true), mVersion(0)
 {
-	const std::vector<MetaDataDecl>& mdd = getMDD();
-	for(auto iter = mdd.cbegin(); iter != mdd.cend(); iter++)
-		set(iter->key, iter->defaultValue);
+	memcpy(mSlots, getDefaults(type), sizeof(mSlots));
+}
+
+const MetaDataList::Slot* MetaDataList::getDefaults(MetaDataListType type)
+{
+	// parsed once and copied into every new list, the default strings themselves stay in the MDD
+	struct Defaults
+	{
+		Slot slots[META_COUNT];
+
+		Defaults(MetaDataListType type)
+		{
+			for(size_t i = 0; i < META_COUNT; i++)
+			{
+				slots[i].value = NULL;
+				slots[i].date = 0;
+			}
+
+			const std::vector<MetaDataDecl>& mdd = getMDDByType(type);
+			for(size_t i = 0; i < mdd.size(); i++)
+				parseValue(mdd[i].type, mdd[i].defaultValue, slots[getMetaDataId(type, i)]);
+		}
+	};
+
+	static const Defaults gameDefaults(GAME_METADATA);
+	static const Defaults folderDefaults(FOLDER_METADATA);
+
+	return (type == GAME_METADATA) ? gameDefaults.slots : folderDefaults.slots;
 }
 
+void MetaDataList::parseValue(MetaDataType type, const std::string& value, Slot& slot)
+{
+	switch(type)
+	{
+		case MD_INT:    { slot.i    = atoi(value.c_str());        } break;
+		case MD_FLOAT:
+		case MD_RATING: { slot.f    = (float)atof(value.c_str()); } break;
+		case MD_BOOL:   { slot.b    = (value == "true");          } break;
+		case MD_DATE:
+		case MD_TIME:   { slot.date = parseDate(value);           } break;
+		default:        {                                         } break;
+	}
+}
+
+MetaDataList::MetaDataList(const MetaDataList& other)
+	: mType(other.mType), mWasChanged(other.mWasChanged), mVersion(0)
+{
+	for(size_t i = 0; i < META_COUNT; i++)
+	{
+		mSlots[i] = other.mSlots[i];
+		if(mSlots[i].value)
+			mSlots[i].value = new std::string(*mSlots[i].value);
+	}
+}
+
+MetaDataList::~MetaDataList()
+{
+	clear();
+}
+
+MetaDataList& MetaDataList::operator=(const MetaDataList& other)
+{
+	if(this == &other)
+		return *this;
+
+	clear();
+
+	mType = other.mType;
+	mWasChanged = other.mWasChanged;
+	mVersion++;
+	for(size_t i = 0; i < META_COUNT; i++)
+	{
+		mSlots[i] = other.mSlots[i];
+		if(mSlots[i].value)
+			mSlots[i].value = new std::string(*mSlots[i].value);
+	}
+
+	return *this;
+}
+
+void MetaDataList::clear()
+{
+	for(size_t i = 0; i < META_COUNT; i++)
+	{
+		delete mSlots[i].value;
+		mSlots[i].value = NULL;
+	}
+}
+
+const MetaDataDecl* MetaDataList::getDecl(MetaDataId id) const
+{
+	// folders have fewer fields than games, asking a folder for one of the others just gets the default
+	if((size_t)id >= META_COUNT)
+		return NULL;
+
+	const int decl = getDeclSlots(mType).decls[id];
+	return (decl >= 0) ? &getMDD()[decl] : NULL;
+}
 
 MetaDataList MetaDataList::createFromXML(MetaDataListType type, pugi::xml_node& node, const std::string& relativeTo)
 {
@@ -76,20 +256,18 @@ MetaDataList MetaDataList::createFromXML(MetaDataListType type, pugi::xml_node&
 
 	const std::vector<MetaDataDecl>& mdd = mdl.getMDD();
 
-	for(auto iter = mdd.cbegin(); iter != mdd.cend(); iter++)
+	for(size_t i = 0; i < mdd.size(); i++)
 	{
-		pugi::xml_node md = node.child(iter->key.c_str());
+		pugi::xml_node md = node.child(mdd[i].key.c_str());
 		if(md)
 		{
 			// if it's a path, resolve relative paths
 			std::string value = md.text().get();
-			if (iter->type == MD_PATH)
+			if (mdd[i].type == MD_PATH)
 			{
 				value = Utils::FileSystem::resolveRelativePath(value, relativeTo, true);
 			}
-			mdl.set(iter->key, value);
-		}else{
-			mdl.set(iter->key, iter->defaultValue);
+			mdl.set(getMetaDataId(type, i), value);
 		}
 	}
 
@@ -100,53 +278,127 @@ void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, cons
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
 
-	for(auto mddIter = mdd.cbegin(); mddIter != mdd.cend(); mddIter++)
+	for(size_t i = 0; i < mdd.size(); i++)
 	{
-		auto mapIter = mMap.find(mddIter->key);
-		if(mapIter != mMap.cend())
-		{
-			// we have this value!
-			// if it's just the default (and we ignore defaults), don't write it
-			if(ignoreDefaults && mapIter->second == mddIter->defaultValue)
-				continue;
-			
-			// try and make paths relative if we can
-			std::string value = mapIter->second;
-			if (mddIter->type == MD_PATH)
-				value = Utils::FileSystem::createRelativePath(value, relativeTo, true);
-
-			parent.append_child(mapIter->first.c_str()).text().set(value.c_str());
-		}
+		const MetaDataId id = getMetaDataId(mType, i);
+
+		// if it's just the default (and we ignore defaults), don't write it
+		if(ignoreDefaults && !mSlots[id].value)
+			continue;
+
+		// try and make paths relative if we can
+		std::string value = get(id);
+		if (mdd[i].type == MD_PATH)
+			value = Utils::FileSystem::createRelativePath(value, relativeTo, true);
+
+		parent.append_child(mdd[i].key.c_str()).text().set(value.c_str());
 	}
 }
 
 void MetaDataList::set(const std::string& key, const std::string& value)
 {
-	mMap[key] = value;
+	set(getMetaDataId(key), value);
+}
+
+void MetaDataList::set(MetaDataId id, const std::string& value)
+{
+	const MetaDataDecl* decl = getDecl(id);
+	if(!decl)
+		return;
+
+	Slot& slot = mSlots[id];
+
+	if(value == decl->defaultValue)
+	{
+		delete slot.value;
+		slot.value = NULL;
+	}
+	else if(slot.value)
+	{
+		*slot.value = value;
+	}
+	else
+	{
+		slot.value = new std::string(value);
+	}
+
+	parseValue(decl->type, value, slot);
 	mWasChanged = true;
+	mVersion++;
 }
 
 const std::string& MetaDataList::get(const std::string& key) const
 {
-	return mMap.at(key);
+	return get(getMetaDataId(key));
 }
 
 int MetaDataList::getInt(const std::string& key) const
 {
-	return atoi(get(key).c_str());
+	return getInt(getMetaDataId(key));
 }
 
 float MetaDataList::getFloat(const std::string& key) const
 {
-	return (float)atof(get(key).c_str());
+	return getFloat(getMetaDataId(key));
+}
+
+const std::string& MetaDataList::get(MetaDataId id) const
+{
+	static const std::string empty;
+
+	const MetaDataDecl* decl = getDecl(id);
+	if(!decl)
+		return empty;
+
+	return mSlots[id].value ? *mSlots[id].value : decl->defaultValue;
+}
+
+int MetaDataList::getInt(MetaDataId id) const
+{
+	const MetaDataDecl* decl = getDecl(id);
+	if(decl && decl->type == MD_INT)
+		return mSlots[id].i;
+
+	return atoi(get(id).c_str());
+}
+
+float MetaDataList::getFloat(MetaDataId id) const
+{
+	const MetaDataDecl* decl = getDecl(id);
+	if(decl && (decl->type == MD_FLOAT || decl->type == MD_RATING))
+		return mSlots[id].f;
+
+	return (float)atof(get(id).c_str());
+}
+
+bool MetaDataList::getBool(MetaDataId id) const
+{
+	const MetaDataDecl* decl = getDecl(id);
+	if(decl && decl->type == MD_BOOL)
+		return mSlots[id].b;
+
+	return get(id) == "true";
+}
+
+long long MetaDataList::getDate(MetaDataId id) const
+{
+	const MetaDataDecl* decl = getDecl(id);
+	if(decl && (decl->type == MD_DATE || decl->type == MD_TIME))
+		return mSlots[id].date;
+
+	return parseDate(get(id));
 }
 
 bool MetaDataList::isDefault()
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
 
-	for (unsigned int i = 1; i < mMap.size(); i++) {
-		if (mMap.at(mdd[i].key) != mdd[i].defaultValue) return false;
+	// the name is always set, so it doesn't count
+	for(size_t i = 0; i < mdd.size(); i++)
+	{
+		const MetaDataId id = getMetaDataId(mType, i);
+		if(id != META_NAME && mSlots[id].value)
+			return false;
 	}
 
 	return true;
@@ -2,7 +2,7 @@
 #ifndef ES_APP_META_DATA_H
 #define ES_APP_META_DATA_H
 
-#include <map>
+#include <string>
 #include <vector>
 
 namespace pugi { class xml_node; }
@@ -39,7 +39,34 @@ enum MetaDataListType
 	FOLDER_METADATA
 };
 
+// Slot of every field in a MetaDataList. Games declare all of them in this order, folders some of them in an order of their own.
+enum MetaDataId
+{
+	META_NAME,
+	META_SORTNAME,
+	META_DESC,
+	META_IMAGE,
+	META_VIDEO,
+	META_MARQUEE,
+	META_THUMBNAIL,
+	META_RATING,
+	META_RELEASEDATE,
+	META_DEVELOPER,
+	META_PUBLISHER,
+	META_GENRE,
+	META_PLAYERS,
+	META_FAVORITE,
+	META_HIDDEN,
+	META_KIDGAME,
+	META_PLAYCOUNT,
+	META_LASTPLAYED,
+
+	META_COUNT
+};
+
 const std::vector<MetaDataDecl>& getMDDByType(MetaDataListType type);
+MetaDataId getMetaDataId(const std::string& key); // META_COUNT if there is no such key
+MetaDataId getMetaDataId(MetaDataListType type, size_t index); // slot of the index-th declaration of the type
 
 class MetaDataList
 {
@@ -48,25 +75,59 @@ public:
 	void appendToXML(pugi::xml_node& parent, bool ignoreDefaults, const std::string& relativeTo) const;
 
 	MetaDataList(MetaDataListType type);
-	
+	MetaDataList(const MetaDataList& other);
+	~MetaDataList();
+
+	MetaDataList& operator=(const MetaDataList& other);
+
 	void set(const std::string& key, const std::string& value);
+	void set(MetaDataId id, const std::string& value);
 
 	const std::string& get(const std::string& key) const;
 	int getInt(const std::string& key) const;
 	float getFloat(const std::string& key) const;
 
+	// typed values are parsed once in set(), reading them is just an array access
+	const std::string& get(MetaDataId id) const;
+	int getInt(MetaDataId id) const;
+	float getFloat(MetaDataId id) const;
+	bool getBool(MetaDataId id) const;
+	long long getDate(MetaDataId id) const; // MD_DATE and MD_TIME as a number that sorts like their ISO strings, 0 if empty and LLONG_MAX if not a date
+
 	bool isDefault();
 
 	bool wasChanged() const;
 	void resetChangedFlag();
 
+	// Bumped by every change, lets users of the values tell if what they derived from them is stale.
+	inline unsigned int getVersion() const { return mVersion; }
+
 	inline MetaDataListType getType() const { return mType; }
 	inline const std::vector<MetaDataDecl>& getMDD() const { return getMDDByType(getType()); }
 
 private:
+	struct Slot
+	{
+		std::string* value; // NULL while the slot holds the declaration's default, which is shared instead of copied
+		union
+		{
+			int       i;
+			float     f;
+			bool      b;
+			long long date;
+		};
+	};
+
+	static const Slot* getDefaults(MetaDataListType type);
+	static void parseValue(MetaDataType type, const std::string& value, Slot& slot);
+
+	const MetaDataDecl* getDecl(MetaDataId id) const; // NULL if the type doesn't declare the field
+	void clear();
+
 	MetaDataListType mType;
-	std::map<std::string, std::string> mMap;
+	Slot mSlots[META_COUNT];
 	bool mWasChanged;
+	unsigned int mVersion;
 };
 
 #endif // ES_APP_META_DATA_H
@@ -0,0 +1,156 @@
+#include "PixelBenchmark.h"
+
+#include "ImageIO.h"
+#include "Log.h"
+#include <chrono>
+#include <functional>
+#include <string.h>
+#include <vector>
+
+static const int RUNS = 20;
+
+struct ImageSize
+{
+	const char* name;
+	size_t width;
+	size_t height;
+};
+
+// a scraped box art, a screenshot and a fan art
+static const ImageSize IMAGE_SIZES[] = { { "boxart", 400, 560 }, { "screenshot", 640, 480 }, { "fanart", 1920, 1080 } };
+
+// What ImageIO did before: the scanlines copied into a temporary buffer, red and blue swapped pixel by pixel, the
+// result copied into the vector
+static std::vector<unsigned char> convertOld(const unsigned char* bitmap, const size_t width, const size_t height)
+{
+	struct Pixel { unsigned char blue, green, red, alpha; };
+
+	unsigned char* tempData = new unsigned char[width * height * 4];
+	for(size_t i = 0; i < height; i++)
+		memcpy(tempData + (i * width * 4), bitmap + (i * width * 4), width * 4);
+
+	for(size_t i = 0; i < width * height; i++)
+	{
+		const Pixel bgra = ((Pixel*)tempData)[i];
+		Pixel rgba;
+		rgba.blue = bgra.red;
+		rgba.green = bgra.green;
+		rgba.red = bgra.blue;
+		rgba.alpha = bgra.alpha;
+		((Pixel*)tempData)[i] = rgba;
+	}
+
+	std::vector<unsigned char> rawData(tempData, tempData + width * height * 4);
+	delete[] tempData;
+	return rawData;
+}
+
+// What ImageIO does now: every scanline converted straight into the buffer the texture adopts
+static unsigned char* convertSinglePass(const unsigned char* bitmap, const size_t width, const size_t height, const bool vectorized)
+{
+	unsigned char* rawData = new unsigned char[width * height * 4];
+	for(size_t i = 0; i < height; i++)
+		ImageIO::convertBGRAToRGBA(bitmap + (i * width * 4), rawData + (i * width * 4), width, vectorized);
+	return rawData;
+}
+
+// The shrunk image, its size a third of the source's, so some destination pixels cover more source columns than others
+static unsigned char* shrink(const unsigned char* rgba, const size_t width, const size_t height, const bool vectorized)
+{
+	unsigned char* rawData = new unsigned char[(width / 3) * (height / 3) * 4];
+	ImageIO::shrinkRGBA32(rgba, width, height, rawData, width / 3, height / 3, vectorized);
+	return rawData;
+}
+
+// Average microseconds per run
+static long long timeRuns(const std::function<void()>& run)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < RUNS; i++)
+		run();
+	const auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / RUNS;
+}
+
+int runPixelBenchmark()
+{
+	int exitCode = 0;
+
+	for(size_t s = 0; s < sizeof(IMAGE_SIZES) / sizeof(IMAGE_SIZES[0]); s++)
+	{
+		const ImageSize& imageSize = IMAGE_SIZES[s];
+		const size_t size = imageSize.width * imageSize.height * 4;
+
+		// anything but uniform, so a swapped channel shows up in the comparison below
+		std::vector<unsigned char> bitmap(size);
+		for(size_t i = 0; i < size; i++)
+			bitmap[i] = (unsigned char)((i * 7) ^ (i >> 5));
+
+		// read from every result, so none of the work can be left out
+		unsigned int checksum = 0;
+
+		const long long oldTime = timeRuns([&]
+		{
+			const std::vector<unsigned char> rawData = convertOld(bitmap.data(), imageSize.width, imageSize.height);
+			checksum += rawData[size / 2];
+		});
+		const long long scalarTime = timeRuns([&]
+		{
+			unsigned char* rawData = convertSinglePass(bitmap.data(), imageSize.width, imageSize.height, false);
+			checksum += rawData[size / 2];
+			delete[] rawData;
+		});
+		const long long vectorizedTime = timeRuns([&]
+		{
+			unsigned char* rawData = convertSinglePass(bitmap.data(), imageSize.width, imageSize.height, true);
+			checksum += rawData[size / 2];
+			delete[] rawData;
+		});
+
+		LOG(LogInfo) << "Pixel benchmark \"" << imageSize.name << "\" (" << imageSize.width << "x" << imageSize.height << "): old " <<
+			oldTime << "us, scalar " << scalarTime << "us, vectorized " << vectorizedTime << "us per image, average of " << RUNS <<
+			" (checksum " << checksum << ")";
+
+		// all three have to agree on every pixel
+		const std::vector<unsigned char> expected = convertOld(bitmap.data(), imageSize.width, imageSize.height);
+		unsigned char* scalar = convertSinglePass(bitmap.data(), imageSize.width, imageSize.height, false);
+		unsigned char* vectorized = convertSinglePass(bitmap.data(), imageSize.width, imageSize.height, true);
+		if(memcmp(expected.data(), scalar, size) || memcmp(expected.data(), vectorized, size))
+		{
+			LOG(LogError) << "Pixel benchmark \"" << imageSize.name << "\": the conversions don't give the same pixels";
+			exitCode = 1;
+		}
+		delete[] scalar;
+		delete[] vectorized;
+
+		const long long shrinkScalarTime = timeRuns([&]
+		{
+			unsigned char* rawData = shrink(bitmap.data(), imageSize.width, imageSize.height, false);
+			checksum += rawData[0];
+			delete[] rawData;
+		});
+		const long long shrinkVectorizedTime = timeRuns([&]
+		{
+			unsigned char* rawData = shrink(bitmap.data(), imageSize.width, imageSize.height, true);
+			checksum += rawData[0];
+			delete[] rawData;
+		});
+
+		LOG(LogInfo) << "Pixel benchmark \"" << imageSize.name << "\" shrunk to a third: scalar " << shrinkScalarTime << "us, vectorized " <<
+			shrinkVectorizedTime << "us per image, average of " << RUNS << " (checksum " << checksum << ")";
+
+		// both have to agree on every pixel
+		unsigned char* shrunkScalar = shrink(bitmap.data(), imageSize.width, imageSize.height, false);
+		unsigned char* shrunkVectorized = shrink(bitmap.data(), imageSize.width, imageSize.height, true);
+		if(memcmp(shrunkScalar, shrunkVectorized, (imageSize.width / 3) * (imageSize.height / 3) * 4))
+		{
+			LOG(LogError) << "Pixel benchmark \"" << imageSize.name << "\": the shrinks don't give the same pixels";
+			exitCode = 1;
+		}
+		delete[] shrunkScalar;
+		delete[] shrunkVectorized;
+	}
+
+	return exitCode;
+}
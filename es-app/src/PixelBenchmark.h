@@ -0,0 +1,12 @@
+#pragma once
+#ifndef ES_APP_PIXEL_BENCHMARK_H
+#define ES_APP_PIXEL_BENCHMARK_H
+
+// Times converting decoded BGRA scanlines into an RGBA texture buffer the way it was done before (a copy of the
+// scanlines, a per-pixel swap, a copy into the result) against the single pass conversion, once forced to scalar code
+// and once with SSE2/NEON, and the box filter shrink the same two ways. Runs on generated pixels at a few typical image
+// sizes, no images or window needed, and checks that the scalar and vectorized versions give the same pixels.
+// Returns the exit code for main().
+int runPixelBenchmark();
+
+#endif // ES_APP_PIXEL_BENCHMARK_H
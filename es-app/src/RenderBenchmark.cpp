@@ -0,0 +1,198 @@
+#include "RenderBenchmark.h"
+
+#include "resources/TextureResource.h"
+#include "views/ViewController.h"
+#include "InputConfig.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Renderer.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include "Window.h"
+#include <SDL_keycode.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+// every frame advances the same time, so animations are at the same point in the same frame every run
+static const int FRAME_TIME    = 16;
+static const int SETTLE_FRAMES = 60; // long enough for any transition to finish
+static const int MOVE_FRAMES   = 10; // between two presses while scrolling
+static const int MOVE_COUNT    = 20;
+
+class BenchmarkRun
+{
+public:
+	BenchmarkRun(Window* window) : mWindow(window), mConfig(DEVICE_KEYBOARD, "Benchmark", "-1")
+	{
+		// the default keyboard mapping, whatever the user configured
+		mConfig.mapInput("up",    Input(DEVICE_KEYBOARD, TYPE_KEY, SDLK_UP,     1, true));
+		mConfig.mapInput("down",  Input(DEVICE_KEYBOARD, TYPE_KEY, SDLK_DOWN,   1, true));
+		mConfig.mapInput("left",  Input(DEVICE_KEYBOARD, TYPE_KEY, SDLK_LEFT,   1, true));
+		mConfig.mapInput("right", Input(DEVICE_KEYBOARD, TYPE_KEY, SDLK_RIGHT,  1, true));
+		mConfig.mapInput("a",     Input(DEVICE_KEYBOARD, TYPE_KEY, SDLK_RETURN, 1, true));
+		mConfig.mapInput("b",     Input(DEVICE_KEYBOARD, TYPE_KEY, SDLK_ESCAPE, 1, true));
+	}
+
+	// Renders frames without any input
+	void wait(const std::string& phase, int frames)
+	{
+		for(int i = 0; i < frames; i++)
+			frame(phase);
+	}
+
+	// Presses and releases a button within one frame, then waits for the rest
+	void press(const std::string& phase, const std::string& button, int frames)
+	{
+		Input input;
+		if(!mConfig.getInputByName(button, &input))
+			return;
+
+		input.value = 1;
+		mWindow->input(&mConfig, input);
+		input.value = 0;
+		mWindow->input(&mConfig, input);
+
+		wait(phase, frames);
+	}
+
+	bool save(const std::string& path)
+	{
+		std::ofstream file(path, std::ios::out | std::ios::trunc);
+		if(!file.is_open())
+		{
+			LOG(LogError) << "Could not write render benchmark report \"" << path << "\"";
+			return false;
+		}
+
+		file << "frame,phase,draws,vertices,draw_calls,state_changes,texture_uploads,uploaded_bytes,textures_created,textures_deleted,cpu_us\n";
+		for(size_t i = 0; i < mFrames.size(); i++)
+		{
+			const Frame& frame = mFrames[i];
+			file << i << "," << frame.phase << "," << frame.stats.draws << "," << frame.stats.vertices << "," <<
+				frame.stats.drawCalls << "," << frame.stats.stateChanges << "," << frame.stats.textureUploads << "," <<
+				frame.stats.uploadedBytes << "," << frame.stats.texturesCreated << "," << frame.stats.texturesDeleted << "," <<
+				frame.cpuTime << "\n";
+		}
+
+		return file.good();
+	}
+
+	// One line per phase, in the order they ran
+	void logSummary()
+	{
+		size_t begin = 0;
+		while(begin < mFrames.size())
+		{
+			const std::string& phase = mFrames[begin].phase;
+			size_t end = begin;
+
+			unsigned int drawCalls = 0;
+			unsigned int maxDrawCalls = 0;
+			unsigned int uploads = 0;
+			long long cpuTime = 0;
+			for(; end < mFrames.size() && mFrames[end].phase == phase; end++)
+			{
+				drawCalls += mFrames[end].stats.drawCalls;
+				maxDrawCalls = std::max(maxDrawCalls, mFrames[end].stats.drawCalls);
+				uploads += mFrames[end].stats.textureUploads;
+				cpuTime += mFrames[end].cpuTime;
+			}
+
+			const size_t count = end - begin;
+			LOG(LogInfo) << "Render benchmark \"" << phase << "\": " << count << " frames, " << (drawCalls / count) << " draw calls avg, " <<
+				maxDrawCalls << " max, " << uploads << " texture uploads, " << (cpuTime / (long long)count) << "us per frame";
+
+			begin = end;
+		}
+	}
+
+private:
+	struct Frame
+	{
+		std::string phase;
+		Renderer::FrameStats stats;
+		int cpuTime; // microseconds for update and render, the only column that varies between runs
+	};
+
+	void frame(const std::string& phase)
+	{
+		// whatever was queued for loading is in RAM before the frame that may draw it
+		TextureResource::waitForLoads();
+
+		const auto start = std::chrono::steady_clock::now();
+		Profiler::beginFrame();
+		mWindow->update(FRAME_TIME);
+		mWindow->render();
+		Renderer::swapBuffers();
+		Profiler::endFrame();
+		const auto end = std::chrono::steady_clock::now();
+
+		Frame frame;
+		frame.phase = phase;
+		frame.stats = Renderer::getFrameStats();
+		frame.cpuTime = (int)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+		mFrames.push_back(frame);
+	}
+
+	Window* mWindow;
+	InputConfig mConfig;
+	std::vector<Frame> mFrames;
+};
+
+int runRenderBenchmark(Window* window, const std::string& reportPath)
+{
+	if(SystemData::sSystemVector.empty())
+	{
+		LOG(LogError) << "No systems to run the render benchmark on";
+		return 1;
+	}
+
+	// the first system that has games, so its gamelist has something to scroll through
+	SystemData* system = SystemData::sSystemVector.front();
+	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); ++it)
+	{
+		if((*it)->getGameCount() > 0)
+		{
+			system = *it;
+			break;
+		}
+	}
+
+	LOG(LogInfo) << "Running render benchmark on system \"" << system->getName() << "\"";
+
+	BenchmarkRun run(window);
+	ViewController* viewController = ViewController::get();
+
+	// system carousel, scrolled away and back so it ends on the same system
+	viewController->goToSystemView(system);
+	run.wait("carousel", SETTLE_FRAMES);
+	for(int i = 0; i < MOVE_COUNT; i++)
+		run.press("carousel", "right", MOVE_FRAMES);
+	for(int i = 0; i < MOVE_COUNT; i++)
+		run.press("carousel", "left", MOVE_FRAMES);
+	run.wait("carousel", SETTLE_FRAMES);
+
+	// its gamelist, as the theme shows it
+	run.press("gamelist", "a", SETTLE_FRAMES);
+	for(int i = 0; i < MOVE_COUNT; i++)
+		run.press("gamelist", "down", MOVE_FRAMES);
+	run.wait("gamelist", SETTLE_FRAMES);
+
+	// the same gamelist as a grid
+	const std::string viewStyle = Settings::getInstance()->getString("GamelistViewStyle");
+	Settings::getInstance()->setString("GamelistViewStyle", "grid");
+	viewController->reloadGameListView(system);
+	run.wait("grid", SETTLE_FRAMES);
+	for(int i = 0; i < MOVE_COUNT; i++)
+		run.press("grid", "down", MOVE_FRAMES);
+	run.wait("grid", SETTLE_FRAMES);
+	Settings::getInstance()->setString("GamelistViewStyle", viewStyle);
+
+	run.logSummary();
+	if(!run.save(reportPath))
+		return 1;
+
+	LOG(LogInfo) << "Render benchmark report written to \"" << reportPath << "\"";
+	return 0;
+}
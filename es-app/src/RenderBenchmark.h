@@ -0,0 +1,15 @@
+#pragma once
+#ifndef ES_APP_RENDER_BENCHMARK_H
+#define ES_APP_RENDER_BENCHMARK_H
+
+#include <string>
+
+class Window;
+
+// Drives the ViewController through a fixed script (system carousel, a gamelist, the same gamelist as a grid) with a fixed
+// frame time, and writes what the renderer did in every frame to a CSV file. Texture loads are waited for before each frame,
+// so the counts are the same from run to run. Meant to be run with --headless on machines without a GPU.
+// Returns the exit code for main().
+int runRenderBenchmark(Window* window, const std::string& reportPath);
+
+#endif // ES_APP_RENDER_BENCHMARK_H
@@ -1,5 +1,7 @@
 #include "ScraperCmdLine.h"
 
+#include "FileFilterIndex.h"
+#include "GamelistWriter.h"
 #include "Log.h"
 #include "platform.h"
 #include "SystemData.h"
@@ -20,6 +22,7 @@ void handle_interrupt_signal(int /*p*/)
 	LOG(LogInfo) << "Interrupt received during scrape...";
 
 	SystemData::deleteSystems();
+	GamelistWriter::deinit();
 
 	exit(1);
 }
@@ -219,6 +222,7 @@ int run_scraper_cmdline()
 					if(choice >= 0 && choice < (int)mdls.size())
 					{
 						params.game->metadata = mdls.at(choice);
+						params.system->getIndex()->addToIndex(params.game);
 						break;
 					}else{
 						out << "Invalid choice.\n";
@@ -230,6 +234,7 @@ int run_scraper_cmdline()
 					//always choose the first choice
 					out << "   name -> " << mdls.at(0).get("name") << "\n";
 					params.game->metadata = mdls.at(0);
+					params.system->getIndex()->addToIndex(params.game);
 					break;
 				}
 
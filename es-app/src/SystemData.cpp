@@ -1,14 +1,23 @@
 #include "SystemData.h"
 
 #include "utils/FileSystemUtil.h"
+#include "utils/ThreadPool.h"
+#include "CacheFile.h"
 #include "CollectionSystemManager.h"
+#include "DirectoryCache.h"
 #include "FileFilterIndex.h"
 #include "FileSorts.h"
 #include "Gamelist.h"
+#include "GamelistCache.h"
+#include "GamelistWriter.h"
 #include "Log.h"
+#include "MameNames.h"
+#include "MediaIndex.h"
 #include "platform.h"
+#include "Profiler.h"
 #include "Settings.h"
 #include "ThemeData.h"
+#include "Window.h"
 #include "views/UIModeController.h"
 #include <pugixml/src/pugixml.hpp>
 #include <fstream>
@@ -22,6 +31,7 @@ SystemData::SystemData(const std::string& name, const std::string& fullName, Sys
 	mName(name), mFullName(fullName), mEnvData(envData), mThemeFolder(themeFolder), mIsCollectionSystem(CollectionSystem), mIsGameSystem(true)
 {
 	mFilterIndex = new FileFilterIndex();
+	mMediaIndex = CollectionSystem ? NULL : new MediaIndex(mEnvData->mStartPath + "/images");
 
 	// if it's an actual system, initialize it, if not, just create the data structure
 	if(!CollectionSystem)
@@ -29,11 +39,24 @@ SystemData::SystemData(const std::string& name, const std::string& fullName, Sys
 		mRootFolder = new FileData(FOLDER, mEnvData->mStartPath, mEnvData, this);
 		mRootFolder->metadata.set("name", mFullName);
 
-		if(!Settings::getInstance()->getBool("ParseGamelistOnly"))
-			populateFolder(mRootFolder);
+		const bool useCache = Settings::getInstance()->getBool("GamelistCache");
+		if(!useCache || !loadGamelistCache(this))
+		{
+			if(!Settings::getInstance()->getBool("ParseGamelistOnly"))
+			{
+				DirectoryCache cache(mName);
+				populateFolder(mRootFolder, cache);
+				cache.save();
+
+				LOG(LogInfo) << "Scanned system \"" << mName << "\": " << cache.getHits() << " folders unchanged, " << cache.getMisses() << " folders read";
+			}
+
+			if(!Settings::getInstance()->getBool("IgnoreGamelist"))
+				parseGamelist(this);
 
-		if(!Settings::getInstance()->getBool("IgnoreGamelist"))
-			parseGamelist(this);
+			if(useCache)
+				saveGamelistCache(this);
+		}
 
 		mRootFolder->sort(FileSorts::SortTypes.at(0));
 
@@ -45,19 +68,17 @@ SystemData::SystemData(const std::string& name, const std::string& fullName, Sys
 		mRootFolder = new FileData(FOLDER, "" + name, mEnvData, this);
 	}
 	setIsGameSystemStatus();
-	loadTheme();
+
+	// game systems may be built on a loader thread, loadConfig() loads their theme on the main thread
+	if(CollectionSystem)
+		loadTheme();
 }
 
 SystemData::~SystemData()
 {
-	//save changed game data back to xml
-	if(!Settings::getInstance()->getBool("IgnoreGamelist") && Settings::getInstance()->getBool("SaveGamelistsOnExit") && !mIsCollectionSystem)
-	{
-		updateGamelist(this);
-	}
-
 	delete mRootFolder;
 	delete mFilterIndex;
+	delete mMediaIndex;
 }
 
 void SystemData::setIsGameSystemStatus()
@@ -68,8 +89,11 @@ void SystemData::setIsGameSystemStatus()
 	mIsGameSystem = (mName != "retropie");
 }
 
-void SystemData::populateFolder(FileData* folder)
+void SystemData::populateFolder(FileData* folder, DirectoryCache& cache)
 {
+	// nested for subfolders
+	PROFILE_SCOPE("SystemData::populateFolder");
+
 	const std::string& folderPath = folder->getPath();
 	if(!Utils::FileSystem::isDirectory(folderPath))
 	{
@@ -88,17 +112,21 @@ void SystemData::populateFolder(FileData* folder)
 		}
 	}
 
+	// to the nanosecond, so a change within the same second as the scan still invalidates the caches
+	const long long folderTime = Utils::FileSystem::getModifiedTimeNs(folderPath);
+	mScannedFolders.push_back(std::make_pair(folderPath, folderTime));
+
 	std::string filePath;
 	std::string extension;
 	bool isGame;
 	bool showHidden = Settings::getInstance()->getBool("ShowHiddenFiles");
-	Utils::FileSystem::stringList dirContent = Utils::FileSystem::getDirContent(folderPath);
-	for(Utils::FileSystem::stringList::const_iterator it = dirContent.cbegin(); it != dirContent.cend(); ++it)
+	const DirectoryCache::Listing& dirContent = cache.getDirContent(folderPath, folderTime);
+	for(DirectoryCache::Listing::const_iterator it = dirContent.cbegin(); it != dirContent.cend(); ++it)
 	{
-		filePath = *it;
+		filePath = it->path;
 
 		// skip hidden files and folders
-		if(!showHidden && Utils::FileSystem::isHidden(filePath))
+		if(!showHidden && it->isHidden)
 			continue;
 
 		//this is a little complicated because we allow a list of extensions to be defined (delimited with a space)
@@ -122,10 +150,10 @@ void SystemData::populateFolder(FileData* folder)
 		}
 
 		//add directories that also do not match an extension as folders
-		if(!isGame && Utils::FileSystem::isDirectory(filePath))
+		if(!isGame && it->isDirectory)
 		{
 			FileData* newFolder = new FileData(FOLDER, filePath, mEnvData, this);
-			populateFolder(newFolder);
+			populateFolder(newFolder, cache);
 
 			//ignore folders that do not contain games
 			if(newFolder->getChildrenByFilename().size() == 0)
@@ -168,7 +196,7 @@ std::vector<std::string> readList(const std::string& str, const char* delims = "
 }
 
 //creates systems from information located in a config file
-bool SystemData::loadConfig()
+bool SystemData::loadConfig(Window* window)
 {
 	deleteSystems();
 
@@ -202,6 +230,8 @@ bool SystemData::loadConfig()
 		return false;
 	}
 
+	std::vector<SystemDecl> systemDecls;
+
 	for(pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
 	{
 		std::string name, fullname, path, cmd, themeFolder;
@@ -266,12 +296,70 @@ bool SystemData::loadConfig()
 		envData->mLaunchCommand = cmd;
 		envData->mPlatformIds = platformIds;
 
-		SystemData* newSys = new SystemData(name, fullname, envData, themeFolder);
+		SystemDecl decl = { name, fullname, envData, themeFolder };
+		systemDecls.push_back(decl);
+	}
+
+	std::vector<SystemData*> systems(systemDecls.size(), NULL);
+
+	if(Settings::getInstance()->getBool("ParallelSystemLoad") && systemDecls.size() > 1)
+	{
+		// make sure the MameNames singleton exists before the loader threads start asking for it
+		MameNames::getInstance();
+
+		// and the folders the loader threads save their caches in, rather than every thread creating them at once
+		Utils::FileSystem::createDirectory(getCacheFilePath("directories"));
+		Utils::FileSystem::createDirectory(getCacheFilePath("gamelists"));
+
+		unsigned int numThreads = std::thread::hardware_concurrency();
+		const int maxThreads = Settings::getInstance()->getInt("SystemLoadThreads");
+		if(maxThreads > 0 && (numThreads == 0 || (unsigned int)maxThreads < numThreads))
+			numThreads = (unsigned int)maxThreads;
+		if(numThreads > systemDecls.size())
+			numThreads = (unsigned int)systemDecls.size();
+
+		LOG(LogInfo) << "Loading " << systemDecls.size() << " systems using " << numThreads << " threads...";
+
+		Utils::ThreadPool pool(numThreads);
+		for(size_t i = 0; i < systemDecls.size(); i++)
+		{
+			const SystemDecl& decl = systemDecls[i];
+			SystemData** result = &systems[i];
+			pool.queueJob([decl, result] { *result = new SystemData(decl.name, decl.fullName, decl.envData, decl.themeFolder); });
+		}
+
+		if(window)
+		{
+			const size_t total = systemDecls.size();
+			pool.wait([window, total](const size_t pending) { window->renderLoadingScreen("", (float)(total - pending) / (float)total); }, 50);
+		}
+		else
+		{
+			pool.wait();
+		}
+	}
+	else
+	{
+		for(size_t i = 0; i < systemDecls.size(); i++)
+		{
+			if(window)
+				window->renderLoadingScreen("", (float)i / (float)systemDecls.size());
+
+			const SystemDecl& decl = systemDecls[i];
+			systems[i] = new SystemData(decl.name, decl.fullName, decl.envData, decl.themeFolder);
+		}
+	}
+
+	// merge the loaded systems in es_systems.cfg order
+	for(auto it = systems.cbegin(); it != systems.cend(); it++)
+	{
+		SystemData* newSys = *it;
 		if(newSys->getRootFolder()->getChildrenByFilename().size() == 0)
 		{
-			LOG(LogWarning) << "System \"" << name << "\" has no games! Ignoring it.";
+			LOG(LogWarning) << "System \"" << newSys->getName() << "\" has no games! Ignoring it.";
 			delete newSys;
 		}else{
+			newSys->loadTheme();
 			sSystemVector.push_back(newSys);
 		}
 	}
@@ -328,11 +416,25 @@ void SystemData::writeExampleConfig(const std::string& path)
 
 void SystemData::deleteSystems()
 {
+	//save changed game data back to xml, the snapshots are taken here and written while the systems are torn down
+	GamelistWriter::getInstance()->saveDirty();
+	if(!Settings::getInstance()->getBool("IgnoreGamelist") && Settings::getInstance()->getBool("SaveGamelistsOnExit"))
+	{
+		for(auto it = sSystemVector.cbegin(); it != sSystemVector.cend(); ++it)
+		{
+			if(!(*it)->isCollection())
+				GamelistWriter::getInstance()->save(*it);
+		}
+	}
+
 	for(unsigned int i = 0; i < sSystemVector.size(); i++)
 	{
 		delete sSystemVector.at(i);
 	}
 	sSystemVector.clear();
+
+	// a reload reads the gamelists again right after this, so they have to be written by then
+	GamelistWriter::getInstance()->flush();
 }
 
 std::string SystemData::getConfigPath(bool forWrite)
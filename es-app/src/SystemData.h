@@ -6,11 +6,15 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <time.h>
 #include <vector>
 
+class DirectoryCache;
 class FileData;
 class FileFilterIndex;
+class MediaIndex;
 class ThemeData;
+class Window;
 
 struct SystemEnvironmentData
 {
@@ -46,7 +50,7 @@ public:
 	unsigned int getDisplayedGameCount() const;
 
 	static void deleteSystems();
-	static bool loadConfig(); //Load the system config file at getConfigPath(). Returns true if no errors were encountered. An example will be written if the file doesn't exist.
+	static bool loadConfig(Window* window = NULL); //Load the system config file at getConfigPath(). Returns true if no errors were encountered. An example will be written if the file doesn't exist. If window is set, loading progress is drawn to it.
 	static void writeExampleConfig(const std::string& path);
 	static std::string getConfigPath(bool forWrite); // if forWrite, will only return ~/.emulationstation/es_systems.cfg, never /etc/emulationstation/es_systems.cfg
 
@@ -68,8 +72,22 @@ public:
 	void loadTheme();
 
 	FileFilterIndex* getIndex() { return mFilterIndex; };
+	MediaIndex* getMediaIndex() { return mMediaIndex; }; // NULL for collections
+
+	// Folders read while populating this system, with their modification time at that point.
+	typedef std::vector<std::pair<std::string, long long>> FolderTimes; // modification times in nanoseconds
+	inline const FolderTimes& getScannedFolders() const { return mScannedFolders; }
+	inline void setScannedFolders(const FolderTimes& folders) { mScannedFolders = folders; }
 
 private:
+	struct SystemDecl
+	{
+		std::string name;
+		std::string fullName;
+		SystemEnvironmentData* envData;
+		std::string themeFolder;
+	};
+
 	bool mIsCollectionSystem;
 	bool mIsGameSystem;
 	std::string mName;
@@ -78,11 +96,13 @@ private:
 	std::string mThemeFolder;
 	std::shared_ptr<ThemeData> mTheme;
 
-	void populateFolder(FileData* folder);
+	void populateFolder(FileData* folder, DirectoryCache& cache);
 	void indexAllGameFilters(const FileData* folder);
 	void setIsGameSystemStatus();
 
 	FileFilterIndex* mFilterIndex;
+	MediaIndex* mMediaIndex;
+	FolderTimes mScannedFolders;
 
 	FileData* mRootFolder;
 };
@@ -35,6 +35,7 @@ public:
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
 	void render(const Transform4x4f& parentTrans) override;
+	bool isChanging() const override { return true; } // spins until the request is done
 
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 private:
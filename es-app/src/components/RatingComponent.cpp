@@ -117,30 +117,11 @@ void RatingComponent::render(const Transform4x4f& parentTrans)
 	trans.round();
 	Renderer::setMatrix(trans);
 
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	
-	glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-	glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-	
 	mFilledTexture->bind();
-	glDrawArrays(GL_TRIANGLES, 0, 6);
+	Renderer::drawTriangles(&mVertices[0], &mColors[0], 6);
 
 	mUnfilledTexture->bind();
-	glDrawArrays(GL_TRIANGLES, 6, 6);
-
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_BLEND);
+	Renderer::drawTriangles(&mVertices[6], &mColors[6 * 4], 6);
 
 	renderChildren(trans);
 }
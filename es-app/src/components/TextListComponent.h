@@ -41,6 +41,8 @@ public:
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
 	void render(const Transform4x4f& parentTrans) override;
+	bool isChanging() const override;
+	int getTimeUntilChange() const override;
 	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
 	void add(const std::string& name, const T& obj, unsigned int colorId);
@@ -85,6 +87,7 @@ private:
 	int mMarqueeOffset;
 	int mMarqueeOffset2;
 	int mMarqueeTime;
+	int mMarqueeWait; // until the marquee starts scrolling, -1 if it doesn't
 
 	Alignment mAlignment;
 	float mHorizontalMargin;
@@ -112,6 +115,7 @@ TextListComponent<T>::TextListComponent(Window* window) :
 	mMarqueeOffset = 0;
 	mMarqueeOffset2 = 0;
 	mMarqueeTime = 0;
+	mMarqueeWait = -1;
 
 	mHorizontalMargin = 0;
 	mAlignment = ALIGN_CENTER;
@@ -289,6 +293,7 @@ template <typename T>
 void TextListComponent<T>::update(int deltaTime)
 {
 	listUpdate(deltaTime);
+	mMarqueeWait = -1;
 
 	if(!isScrolling() && size() > 0)
 	{
@@ -320,12 +325,32 @@ void TextListComponent<T>::update(int deltaTime)
 
 			if(mMarqueeOffset > (scrollLength - (limit - returnLength)))
 				mMarqueeOffset2 = (int)(mMarqueeOffset - (scrollLength + returnLength));
+
+			if(mMarqueeTime < delay)
+				mMarqueeWait = (int)(delay - mMarqueeTime);
 		}
 	}
 
 	GuiComponent::update(deltaTime);
 }
 
+template <typename T>
+bool TextListComponent<T>::isChanging() const
+{
+	// the marquee stands still at the start of every loop
+	return IList<TextListData, T>::isChanging() || (mMarqueeOffset != 0) || (mMarqueeOffset2 != 0);
+}
+
+template <typename T>
+int TextListComponent<T>::getTimeUntilChange() const
+{
+	const int time = IList<TextListData, T>::getTimeUntilChange();
+	if(mMarqueeWait >= 0 && (time < 0 || mMarqueeWait < time))
+		return mMarqueeWait;
+
+	return time;
+}
+
 //list management stuff
 template <typename T>
 void TextListComponent<T>::add(const std::string& name, const T& obj, unsigned int color)
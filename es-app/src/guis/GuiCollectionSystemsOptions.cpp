@@ -139,7 +139,7 @@ GuiCollectionSystemsOptions::~GuiCollectionSystemsOptions()
 void GuiCollectionSystemsOptions::addSystemsToMenu()
 {
 
-	std::map<std::string, CollectionSystemData> autoSystems = CollectionSystemManager::get()->getAutoCollectionSystems();
+	const std::map<std::string, CollectionSystemData>& autoSystems = CollectionSystemManager::get()->getAutoCollectionSystems();
 
 	autoOptionList = std::make_shared< OptionListComponent<std::string> >(mWindow, _("SELECT COLLECTIONS"), true);
 
@@ -150,7 +150,7 @@ void GuiCollectionSystemsOptions::addSystemsToMenu()
 	}
 	mMenu.addWithLabel(_("AUTOMATIC GAME COLLECTIONS"), autoOptionList);
 
-	std::map<std::string, CollectionSystemData> customSystems = CollectionSystemManager::get()->getCustomCollectionSystems();
+	const std::map<std::string, CollectionSystemData>& customSystems = CollectionSystemManager::get()->getCustomCollectionSystems();
 
 	customOptionList = std::make_shared< OptionListComponent<std::string> >(mWindow, _("SELECT COLLECTIONS"), true);
 
@@ -112,6 +112,11 @@ void GuiFastSelect::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool GuiFastSelect::isChanging() const
+{
+	return GuiComponent::isChanging() || (mScrollDir != 0);
+}
+
 void GuiFastSelect::scroll()
 {
 	mLetterId += mScrollDir;
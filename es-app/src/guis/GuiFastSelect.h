@@ -15,6 +15,7 @@ public:
 
 	bool input(InputConfig* config, Input input);
 	void update(int deltaTime);
+	bool isChanging() const override;
 
 private:
 	void setScrollDir(int dir);
@@ -379,6 +379,12 @@ void GuiMenu::openOtherSettings()
 	s->addWithLabel(_("VRAM LIMIT"), max_vram);
 	s->addSaveFunc([max_vram] { Settings::getInstance()->setInt("MaxVRAM", (int)Math::round(max_vram->getValue())); });
 
+	// maximum texture ram
+	auto max_texture_ram = std::make_shared<SliderComponent>(mWindow, 0.f, 1000.f, 10.f, _("Mb"));
+	max_texture_ram->setValue((float)(Settings::getInstance()->getInt("MaxTextureRAM")));
+	s->addWithLabel(_("TEXTURE RAM LIMIT"), max_texture_ram);
+	s->addSaveFunc([max_texture_ram] { Settings::getInstance()->setInt("MaxTextureRAM", (int)Math::round(max_texture_ram->getValue())); });
+
 	// power saver
 	auto power_saver = std::make_shared< OptionListComponent<std::string> >(mWindow, _("POWER SAVER MODES"), false);
 	std::vector<std::string> modes;
@@ -410,6 +416,11 @@ void GuiMenu::openOtherSettings()
 	s->addWithLabel(_("PARSE GAMESLISTS ONLY"), parse_gamelists);
 	s->addSaveFunc([parse_gamelists] { Settings::getInstance()->setBool("ParseGamelistOnly", parse_gamelists->getState()); });
 
+	auto parallel_load = std::make_shared<SwitchComponent>(mWindow);
+	parallel_load->setState(Settings::getInstance()->getBool("ParallelSystemLoad"));
+	s->addWithLabel(_("LOAD SYSTEMS IN PARALLEL"), parallel_load);
+	s->addSaveFunc([parallel_load] { Settings::getInstance()->setBool("ParallelSystemLoad", parallel_load->getState()); });
+
 	// hidden files
 	auto hidden_files = std::make_shared<SwitchComponent>(mWindow);
 	hidden_files->setState(Settings::getInstance()->getBool("ShowHiddenFiles"));
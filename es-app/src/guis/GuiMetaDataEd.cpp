@@ -16,6 +16,7 @@
 #include "CollectionSystemManager.h"
 #include "FileData.h"
 #include "FileFilterIndex.h"
+#include "GamelistWriter.h"
 #include "SystemData.h"
 #include "Window.h"
 #include "Locale.h"
@@ -207,6 +208,8 @@ void GuiMetaDataEd::save()
 
 	// update respective Collection Entries
 	CollectionSystemManager::get()->refreshCollectionSystems(mScraperParams.game);
+
+	GamelistWriter::getInstance()->markDirty(mScraperParams.game->getSourceFileData()->getSystem());
 }
 
 void GuiMetaDataEd::fetch()
@@ -6,7 +6,9 @@
 #include "components/TextComponent.h"
 #include "guis/GuiMsgBox.h"
 #include "views/ViewController.h"
-#include "Gamelist.h"
+#include "CollectionSystemManager.h"
+#include "FileFilterIndex.h"
+#include "GamelistWriter.h"
 #include "PowerSaver.h"
 #include "SystemData.h"
 #include "Window.h"
@@ -76,7 +78,10 @@ GuiScraperMulti::~GuiScraperMulti()
 {
 	// view type probably changed (basic -> detailed)
 	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+	{
+		ViewController::get()->resetGameListViewType(*it);
 		ViewController::get()->reloadGameListView(*it, false);
+	}
 }
 
 void GuiScraperMulti::onSizeChanged()
@@ -116,7 +121,9 @@ void GuiScraperMulti::acceptResult(const ScraperSearchResult& result)
 	ScraperSearchParams& search = mSearchQueue.front();
 
 	search.game->metadata = result.mdl;
-	updateGamelist(search.system);
+	search.system->getIndex()->addToIndex(search.game);
+	CollectionSystemManager::get()->refreshCollectionSystems(search.game);
+	GamelistWriter::getInstance()->markDirty(search.system, true);
 
 	mSearchQueue.pop();
 	mCurrentGame++;
@@ -7,11 +7,16 @@
 #include "views/ViewController.h"
 #include "CollectionSystemManager.h"
 #include "EmulationStation.h"
+#include "GamelistBenchmark.h"
+#include "GamelistWriter.h"
 #include "InputManager.h"
 #include "Log.h"
 #include "MameNames.h"
+#include "PixelBenchmark.h"
 #include "platform.h"
 #include "PowerSaver.h"
+#include "Profiler.h"
+#include "RenderBenchmark.h"
 #include "ScraperCmdLine.h"
 #include "Settings.h"
 #include "SystemData.h"
@@ -31,6 +36,10 @@
 #include "Locale.h"
 
 bool scrape_cmdline = false;
+std::string render_benchmark_report;
+std::string gamelist_benchmark_folder;
+bool pixel_benchmark = false;
+std::string profile_trace;
 volatile static bool signalCaught = false;
 
 bool parseArgs(int argc, char* argv[])
@@ -123,10 +132,52 @@ bool parseArgs(int argc, char* argv[])
 		}else if(strcmp(argv[i], "--scrape") == 0)
 		{
 			scrape_cmdline = true;
+		}else if(strcmp(argv[i], "--headless") == 0)
+		{
+			Settings::getInstance()->setBool("Headless", true);
+		}else if(strcmp(argv[i], "--render-benchmark") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "No report file supplied.";
+				return false;
+			}
+
+			render_benchmark_report = argv[i + 1];
+			Settings::getInstance()->setBool("SplashScreen", false);
+			i++; // skip report file
+		}else if(strcmp(argv[i], "--gamelist-benchmark") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "No benchmark folder supplied.";
+				return false;
+			}
+
+			gamelist_benchmark_folder = argv[i + 1];
+			i++; // skip benchmark folder
+		}else if(strcmp(argv[i], "--pixel-benchmark") == 0)
+		{
+			pixel_benchmark = true;
+		}else if(strcmp(argv[i], "--profile") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "No trace file supplied.";
+				return false;
+			}
+
+			profile_trace = argv[i + 1];
+			i++; // skip trace file
 		}else if(strcmp(argv[i], "--max-vram") == 0)
 		{
 			int maxVRAM = atoi(argv[i + 1]);
 			Settings::getInstance()->setInt("MaxVRAM", maxVRAM);
+		}else if(strcmp(argv[i], "--max-texture-ram") == 0)
+		{
+			int maxTextureRAM = atoi(argv[i + 1]);
+			Settings::getInstance()->setInt("MaxTextureRAM", maxTextureRAM);
+			i++; // skip size
 		}
 		else if (strcmp(argv[i], "--force-kiosk") == 0)
 		{
@@ -165,7 +216,13 @@ bool parseArgs(int argc, char* argv[])
 				"--scrape			scrape using command line interface\n"
 				"--windowed			not fullscreen, should be used with --resolution\n"
 				"--vsync [1/on or 0/off]		turn vsync on or off (default is on)\n"
+				"--headless			no window or OpenGL, draws and texture uploads are only counted\n"
+				"--render-benchmark [file]	run a scripted walk through the views and write per-frame renderer stats to a CSV file\n"
+				"--gamelist-benchmark [folder]	time saving a 30000 game gamelist written to the folder, then quit\n"
+				"--pixel-benchmark		time the decoded pixel conversion and shrink, old against scalar and SSE2/NEON, then quit\n"
+				"--profile [file]		time frames and subsystems, log their percentiles and write a Chrome trace (chrome://tracing) on exit\n"
 				"--max-vram [size]		Max VRAM to use in Mb before swapping. 0 for unlimited\n"
+				"--max-texture-ram [size]	Max RAM to keep decoded textures in, in Mb. 0 for unlimited\n"
 				"--force-kid		Force the UI mode to be Kid\n"
 				"--force-kiosk		Force the UI mode to be Kiosk\n"
 				"--force-disable-filters		Force the UI to ignore applied filters in gamelist\n"
@@ -198,11 +255,11 @@ bool verifyHomeFolderExists()
 }
 
 // Returns true if everything is OK,
-bool loadSystemConfigFile(const char** errorString)
+bool loadSystemConfigFile(Window* window, const char** errorString)
 {
 	*errorString = NULL;
 
-	if(!SystemData::loadConfig())
+	if(!SystemData::loadConfig(window))
 	{
 		LOG(LogError) << "Error while parsing systems configuration file!";
 		*errorString = _("IT LOOKS LIKE YOUR SYSTEMS CONFIGURATION FILE HAS NOT BEEN SET UP OR IS INVALID. YOU'LL NEED TO DO THIS BY HAND, UNFORTUNATELY.\n\n" \
@@ -341,6 +398,16 @@ int main(int argc, char* argv[])
 
 	setLocale(argv[0]);
 
+	// from here on, so loading the systems is in the trace too
+	if(!profile_trace.empty())
+		Profiler::start(true);
+
+	// no window or systems needed for these
+	if(!gamelist_benchmark_folder.empty())
+		return runGamelistBenchmark(gamelist_benchmark_folder);
+	if(pixel_benchmark)
+		return runPixelBenchmark();
+
 #ifndef WIN32
 	// Do a clean exit when signaled with SIGHUP, SIGINT and SIGTERM. SDL2 will not install a handle for SIGINT and SIGTERM
 	// if one is already set.
@@ -372,15 +439,18 @@ int main(int argc, char* argv[])
 			return 1;
 		}
 
-		std::string glExts = (const char*)glGetString(GL_EXTENSIONS);
-		LOG(LogInfo) << "Checking available OpenGL extensions...";
-		LOG(LogInfo) << " ARB_texture_non_power_of_two: " << (glExts.find("ARB_texture_non_power_of_two") != std::string::npos ? "ok" : "MISSING");
+		if(!Renderer::isHeadless())
+		{
+			std::string glExts = (const char*)glGetString(GL_EXTENSIONS);
+			LOG(LogInfo) << "Checking available OpenGL extensions...";
+			LOG(LogInfo) << " ARB_texture_non_power_of_two: " << (glExts.find("ARB_texture_non_power_of_two") != std::string::npos ? "ok" : "MISSING");
+		}
 		if(Settings::getInstance()->getBool("SplashScreen"))
 			window.renderLoadingScreen();
 	}
 
 	const char* errorMsg = NULL;
-	if(!loadSystemConfigFile(&errorMsg))
+	if(!loadSystemConfigFile((!scrape_cmdline && Settings::getInstance()->getBool("SplashScreen")) ? &window : NULL, &errorMsg))
 	{
 		// something went terribly wrong
 		if(errorMsg == NULL)
@@ -410,14 +480,14 @@ int main(int argc, char* argv[])
 	//dont generate joystick events while we're loading (hopefully fixes "automatically started emulator" bug)
 	SDL_JoystickEventState(SDL_DISABLE);
 
-	// preload what we can right away instead of waiting for the user to select it
-	// this makes for no delays when accessing content, but a longer startup time
+	// build the gamelist views the user can reach right away, the others are built while idle
 	ViewController::get()->preload();
 
 	//choose which GUI to open depending on if an input configuration already exists
 	if(errorMsg == NULL)
 	{
-		if(Utils::FileSystem::exists(InputManager::getConfigPath()) && InputManager::getInstance()->getNumConfiguredDevices() > 0)
+		// the benchmark brings its own input, it doesn't need a configured device
+		if((Utils::FileSystem::exists(InputManager::getConfigPath()) && InputManager::getInstance()->getNumConfiguredDevices() > 0) || !render_benchmark_report.empty())
 		{
 			ViewController::get()->goToStart();
 		}else{
@@ -432,13 +502,33 @@ int main(int argc, char* argv[])
 	int ps_time = SDL_GetTicks();
 
 	bool running = true;
+	int exitCode = 0;
+
+	//run the scripted benchmark instead of waiting for input, then quit
+	if(!render_benchmark_report.empty())
+	{
+		exitCode = runRenderBenchmark(&window, render_benchmark_report);
+		running = false;
+	}
 
 	while(running && !signalCaught)
 	{
 		SDL_Event event;
 		bool ps_standby = PowerSaver::getState() && (int) SDL_GetTicks() - ps_time > PowerSaver::getMode();
 
-		if(ps_standby ? SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) : SDL_PollEvent(&event))
+		// nothing changed on screen last frame, so rather than spinning wait for input until the next update has
+		// something to do, finished texture loads wake us up too
+		bool still = !ps_standby && window.isFrameStill();
+		int stillWait = 0;
+		if(still)
+		{
+			stillWait = window.getTimeUntilChange();
+			const int saveWait = GamelistWriter::getInstance()->getTimeUntilSave();
+			if(saveWait >= 0 && saveWait < stillWait)
+				stillWait = saveWait;
+		}
+
+		if(ps_standby ? SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) : (still ? SDL_WaitEventTimeout(&event, stillWait) : SDL_PollEvent(&event)))
 		{
 			do
 			{
@@ -463,6 +553,8 @@ int main(int argc, char* argv[])
 			ps_time = SDL_GetTicks();
 		}
 
+		GamelistWriter::getInstance()->update();
+
 		if(window.isSleeping())
 		{
 			lastTime = SDL_GetTicks();
@@ -478,13 +570,25 @@ int main(int argc, char* argv[])
 		if(deltaTime < 0)
 			deltaTime = 1000;
 
+		Profiler::beginFrame();
 		window.update(deltaTime);
-		window.render();
-		Renderer::swapBuffers();
+		if(!window.isFrameStill())
+		{
+			window.render();
+			Renderer::swapBuffers();
+			Profiler::endFrame();
+		}
 
 		Log::flush();
 	}
 
+	if(!profile_trace.empty())
+	{
+		Profiler::stop();
+		Profiler::logSummary();
+		Profiler::writeTrace(profile_trace);
+	}
+
 	while(window.peekGui() != ViewController::get())
 		delete window.peekGui();
 	window.deinit();
@@ -492,6 +596,7 @@ int main(int argc, char* argv[])
 	MameNames::deinit();
 	CollectionSystemManager::deinit();
 	SystemData::deleteSystems();
+	GamelistWriter::deinit();
 
 	// call this ONLY when linking with FreeImage as a static library
 #ifdef FREEIMAGE_LIB
@@ -500,5 +605,5 @@ int main(int argc, char* argv[])
 
 	LOG(LogInfo) << "EmulationStation cleanly shutting down.";
 
-	return 0;
+	return exitCode;
 }
@@ -13,6 +13,8 @@
 #include "views/UIModeController.h"
 #include "FileFilterIndex.h"
 #include "Log.h"
+#include "MediaIndex.h"
+#include "Profiler.h"
 #include "Settings.h"
 #include "SystemData.h"
 #include "Window.h"
@@ -20,6 +22,9 @@
 
 ViewController* ViewController::sInstance = NULL;
 
+// how long input has to be quiet before views are built ahead of time
+static const int PREWARM_DELAY = 250;
+
 ViewController* ViewController::get()
 {
 	assert(sInstance);
@@ -33,7 +38,7 @@ void ViewController::init(Window* window)
 }
 
 ViewController::ViewController(Window* window)
-	: GuiComponent(window), mCurrentView(nullptr), mCamera(Transform4x4f::Identity()), mFadeOpacity(0), mLockInput(false)
+	: GuiComponent(window), mCurrentView(nullptr), mCamera(Transform4x4f::Identity()), mFadeOpacity(0), mLockInput(false), mIdleTime(0), mPrewarmed(false)
 {
 	mState.viewing = NOTHING;
 }
@@ -199,6 +204,9 @@ void ViewController::playViewTransition()
 
 void ViewController::onFileChanged(FileData* file, FileChangeType change)
 {
+	if(change == FILE_METADATA_CHANGED)
+		noteGameMedia(file->getSystem(), file);
+
 	auto it = mGameListViews.find(file->getSystem());
 	if(it != mGameListViews.cend())
 		it->second->onFileChanged(file, change);
@@ -266,6 +274,10 @@ void ViewController::removeGameListView(SystemData* system)
 		exists->second.reset();
 		mGameListViews.erase(system);
 	}
+
+	// whatever it is made of has changed
+	mSystemMedia.erase(system);
+	mPrewarmed = false;
 }
 
 std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* system)
@@ -279,38 +291,8 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	//if we didn't, make it, remember it, and return it
 	std::shared_ptr<IGameListView> view;
 
-	bool themeHasVideoView = system->getTheme()->hasView("video");
-
 	//decide type
-	GameListViewType selectedViewType = AUTOMATIC;
-
-	std::string viewPreference = Settings::getInstance()->getString("GamelistViewStyle");
-	if (viewPreference.compare("basic") == 0)
-		selectedViewType = BASIC;
-	if (viewPreference.compare("detailed") == 0)
-		selectedViewType = DETAILED;
-	if (viewPreference.compare("grid") == 0)
-		selectedViewType = GRID;
-	if (viewPreference.compare("video") == 0)
-		selectedViewType = VIDEO;
-
-	if (selectedViewType == AUTOMATIC)
-	{
-		std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME | FOLDER);
-		for (auto it = files.cbegin(); it != files.cend(); it++)
-		{
-			if (themeHasVideoView && !(*it)->getVideoPath().empty())
-			{
-				selectedViewType = VIDEO;
-				break;
-			}
-			else if (!(*it)->getThumbnailPath().empty())
-			{
-				selectedViewType = DETAILED;
-				// Don't break out in case any subsequent files have video
-			}
-		}
-	}
+	GameListViewType selectedViewType = getGameListViewType(system);
 
 	// Create the view
 	switch (selectedViewType)
@@ -342,6 +324,70 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	return view;
 }
 
+ViewController::GameListViewType ViewController::getGameListViewType(SystemData* system)
+{
+	std::string viewPreference = Settings::getInstance()->getString("GamelistViewStyle");
+	if (viewPreference.compare("basic") == 0)
+		return BASIC;
+	if (viewPreference.compare("detailed") == 0)
+		return DETAILED;
+	if (viewPreference.compare("grid") == 0)
+		return GRID;
+	if (viewPreference.compare("video") == 0)
+		return VIDEO;
+
+	auto media = mSystemMedia.find(system);
+	if (media == mSystemMedia.cend())
+	{
+		SystemMedia found = { false, false };
+		std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME | FOLDER);
+
+		// scraped media is in the metadata, only look for files next to the games if that isn't enough
+		for (auto it = files.cbegin(); it != files.cend() && !(found.video && found.thumbnail); it++)
+		{
+			if (!(*it)->metadata.get(META_VIDEO).empty())
+				found.video = true;
+			if (!(*it)->metadata.get(META_THUMBNAIL).empty() || !(*it)->metadata.get(META_IMAGE).empty())
+				found.thumbnail = true;
+		}
+
+		for (auto it = files.cbegin(); it != files.cend() && !(found.video && found.thumbnail); it++)
+		{
+			if (!found.video && !(*it)->getVideoPath().empty())
+				found.video = true;
+			if (!found.thumbnail && !(*it)->getThumbnailPath().empty())
+				found.thumbnail = true;
+		}
+
+		media = mSystemMedia.insert(std::make_pair(system, found)).first;
+	}
+
+	if (media->second.video && system->getTheme()->hasView("video"))
+		return VIDEO;
+	if (media->second.thumbnail)
+		return DETAILED;
+
+	return BASIC;
+}
+
+void ViewController::noteGameMedia(SystemData* system, FileData* game)
+{
+	// a system that wasn't looked at yet is looked up in full when it is
+	auto media = mSystemMedia.find(system);
+	if (media == mSystemMedia.end() || game->getType() != GAME)
+		return;
+
+	if (!media->second.video && !game->getVideoPath().empty())
+		media->second.video = true;
+	if (!media->second.thumbnail && !game->getThumbnailPath().empty())
+		media->second.thumbnail = true;
+}
+
+void ViewController::resetGameListViewType(SystemData* system)
+{
+	mSystemMedia.erase(system);
+}
+
 std::shared_ptr<SystemView> ViewController::getSystemListView()
 {
 	//if we already made one, return that one
@@ -357,6 +403,8 @@ std::shared_ptr<SystemView> ViewController::getSystemListView()
 
 bool ViewController::input(InputConfig* config, Input input)
 {
+	mIdleTime = 0;
+
 	if(mLockInput)
 		return true;
 
@@ -387,10 +435,64 @@ void ViewController::update(int deltaTime)
 	}
 
 	updateSelf(deltaTime);
+
+	// at most one view per frame, and only while nothing moves so building it can't make anything stutter
+	if(mIdleTime < PREWARM_DELAY)
+		mIdleTime += deltaTime;
+	else if(!mLockInput && !isAnimationPlaying(0) && !(mSystemListView && mSystemListView->isAnimationPlaying(0)))
+		prewarmGameListView();
+}
+
+void ViewController::prewarmGameListView()
+{
+	std::vector<SystemData*>& sysVec = SystemData::sSystemVector;
+	if(sysVec.empty())
+	{
+		mPrewarmed = true;
+		return;
+	}
+
+	// the system in focus first, then its neighbours, working outwards in both directions
+	SystemData* focus = sysVec.front();
+	if(mState.viewing == GAME_LIST)
+		focus = mState.getSystem();
+	else if(mState.viewing == SYSTEM_SELECT && mSystemListView)
+		focus = mSystemListView->getSelected();
+
+	const int count = (int)sysVec.size();
+	const int focusId = getSystemId(focus) % count;
+	for(int distance = 0; distance <= count / 2; distance++)
+	{
+		SystemData* candidates[2] = { sysVec[(focusId + distance) % count], sysVec[(focusId - distance + count) % count] };
+		for(int i = 0; i < 2; i++)
+		{
+			if(mGameListViews.find(candidates[i]) == mGameListViews.cend())
+			{
+				getGameListView(candidates[i]);
+				return;
+			}
+		}
+	}
+
+	mPrewarmed = true;
+}
+
+bool ViewController::isChanging() const
+{
+	// the views that are out of sight aren't updated, so they don't count
+	for(unsigned char i = 0; i < MAX_ANIMATIONS; i++)
+	{
+		if(isAnimationPlaying(i))
+			return true;
+	}
+
+	return !mPrewarmed || (mCurrentView && mCurrentView->isChanging());
 }
 
 void ViewController::render(const Transform4x4f& parentTrans)
 {
+	PROFILE_SCOPE("ViewController::render");
+
 	Transform4x4f trans = mCamera * parentTrans;
 	Transform4x4f transInverse;
 	transInverse.invert(trans);
@@ -430,11 +532,37 @@ void ViewController::render(const Transform4x4f& parentTrans)
 
 void ViewController::preload()
 {
-	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
-	{
+	std::vector<SystemData*>& sysVec = SystemData::sSystemVector;
+	for(auto it = sysVec.cbegin(); it != sysVec.cend(); it++)
 		(*it)->getIndex()->resetFilters();
-		getGameListView(*it);
+
+	if(sysVec.empty())
+		return;
+
+	// wherever goToStart() is going to go
+	SystemData* system = sysVec.front();
+	std::string requestedSystem = Settings::getInstance()->getString("StartupSystem");
+	for(auto it = sysVec.cbegin(); it != sysVec.cend(); it++)
+	{
+		if((*it)->getName() == requestedSystem)
+		{
+			system = *it;
+			break;
+		}
 	}
+
+	const int count = (int)sysVec.size();
+	const int id = getSystemId(system);
+	getGameListView(system);
+	getGameListView(sysVec[(id + 1) % count]);
+	getGameListView(sysVec[(id + count - 1) % count]);
+}
+
+void ViewController::reloadGameListView(SystemData* system, bool reloadTheme)
+{
+	auto it = mGameListViews.find(system);
+	if(it != mGameListViews.cend())
+		reloadGameListView(it->second.get(), reloadTheme);
 }
 
 void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
@@ -448,6 +576,10 @@ void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
 			FileData* cursor = view->getCursor();
 			mGameListViews.erase(it);
 
+			// local media may have been added since
+			if(system->getMediaIndex())
+				system->getMediaIndex()->invalidate();
+
 			if(reloadTheme)
 				system->loadTheme();
 			system->getIndex()->setUIModeFilters();
@@ -478,13 +610,26 @@ void ViewController::reloadAll()
 		cursorMap[it->first] = it->second->getCursor();
 	}
 	mGameListViews.clear();
+	mPrewarmed = false;
+
 
+	// load themes and reset filters, not only of the systems that had a view
+	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+	{
+		if((*it)->getMediaIndex())
+			(*it)->getMediaIndex()->invalidate();
+		(*it)->loadTheme();
+		(*it)->getIndex()->resetFilters();
+	}
 
-	// load themes, create gamelistviews and reset filters
+	// recreate the gamelistviews there were
 	for(auto it = cursorMap.cbegin(); it != cursorMap.cend(); it++)
 	{
-		it->first->loadTheme();
-		it->first->getIndex()->resetFilters();
+		if(getSystemId(it->first) == (int)SystemData::sSystemVector.size())
+		{
+			it->first->loadTheme();
+			it->first->getIndex()->resetFilters();
+		}
 		getGameListView(it->first)->setCursor(it->second);
 	}
 
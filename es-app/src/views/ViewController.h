@@ -20,14 +20,14 @@ public:
 
 	virtual ~ViewController();
 
-	// Try to completely populate the GameListView map.
-	// Caches things so there's no pauses during transitions.
+	// Builds the gamelist views of the start system and its neighbours.
+	// The others are built when they are first needed, or earlier whenever nothing is moving on screen.
 	void preload();
 
 	// If a basic view detected a metadata change, it can request to recreate
 	// the current gamelist view (as it may change to be detailed).
 	void reloadGameListView(IGameListView* gamelist, bool reloadTheme = false);
-	inline void reloadGameListView(SystemData* system, bool reloadTheme = false) { reloadGameListView(getGameListView(system).get(), reloadTheme); }
+	void reloadGameListView(SystemData* system, bool reloadTheme = false); // does nothing if the system has no view yet
 	void reloadAll(); // Reload everything with a theme.  Used when the "ThemeSet" setting changes.
 
 	// Navigation.
@@ -47,6 +47,7 @@ public:
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
 	void render(const Transform4x4f& parentTrans) override;
+	bool isChanging() const override;
 
 	enum ViewMode
 	{
@@ -85,20 +86,36 @@ public:
 	std::shared_ptr<SystemView> getSystemListView();
 	void removeGameListView(SystemData* system);
 
+	// The type of view getGameListView() builds for the system, never BASIC when AUTOMATIC found media.
+	// What media the system's games have is only looked up once, then kept up to date by noteGameMedia().
+	GameListViewType getGameListViewType(SystemData* system);
+	void noteGameMedia(SystemData* system, FileData* game);
+	void resetGameListViewType(SystemData* system); // looks the media up again next time, e.g. after scraping
+
 private:
 	ViewController(Window* window);
 	static ViewController* sInstance;
 
 	void playViewTransition();
 	int getSystemId(SystemData* system);
-	
+	void prewarmGameListView();
+
+	struct SystemMedia
+	{
+		bool video;
+		bool thumbnail;
+	};
+
 	std::shared_ptr<GuiComponent> mCurrentView;
 	std::map< SystemData*, std::shared_ptr<IGameListView> > mGameListViews;
+	std::map< SystemData*, SystemMedia > mSystemMedia;
 	std::shared_ptr<SystemView> mSystemListView;
 	
 	Transform4x4f mCamera;
 	float mFadeOpacity;
 	bool mLockInput;
+	int mIdleTime; // since the last input, views are only prewarmed once it is quiet
+	bool mPrewarmed; // every system has its view
 
 	State mState;
 };
@@ -33,8 +33,12 @@ void BasicGameListView::onFileChanged(FileData* file, FileChangeType change)
 	if(change == FILE_METADATA_CHANGED)
 	{
 		// might switch to a detailed view
-		ViewController::get()->reloadGameListView(this);
-		return;
+		ViewController::get()->noteGameMedia(mRoot->getSystem(), file);
+		if(ViewController::get()->getGameListViewType(mRoot->getSystem()) != ViewController::BASIC)
+		{
+			ViewController::get()->reloadGameListView(this);
+			return;
+		}
 	}
 
 	ISimpleGameListView::onFileChanged(file, change);
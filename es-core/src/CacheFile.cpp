@@ -0,0 +1,102 @@
+#include "CacheFile.h"
+
+#include "utils/FileSystemUtil.h"
+#include "Log.h"
+#include <fstream>
+
+std::string getCacheFilePath(const std::string& name)
+{
+	return Utils::FileSystem::getHomePath() + "/.emulationstation/cache/" + name;
+}
+
+CacheWriter::CacheWriter(const char magic[4], const uint32_t version)
+{
+	mBuffer.append(magic, 4);
+	write(version);
+}
+
+CacheWriter::CacheWriter()
+{
+}
+
+void CacheWriter::writeString(const std::string& str)
+{
+	write((uint32_t)str.size());
+	mBuffer.append(str);
+}
+
+bool CacheWriter::save(const std::string& path) const
+{
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(path));
+
+	// written next to the real file and swapped in, so the cache is never seen half written
+	const std::string tempPath = path + ".tmp";
+	std::ofstream stream(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	const bool written = stream.is_open() && stream.write(mBuffer.data(), mBuffer.size());
+	stream.close();
+
+	if(!written || !Utils::FileSystem::renameFile(tempPath, path))
+	{
+		LOG(LogError) << "Error saving cache file \"" << path << "\"!";
+		Utils::FileSystem::removeFile(tempPath);
+		return false;
+	}
+
+	return true;
+}
+
+CacheReader::CacheReader() : mPos(0), mFileSize(0)
+{
+}
+
+bool CacheReader::load(const std::string& path, const char magic[4], const uint32_t version, const size_t headerSize)
+{
+	mStream.open(path, std::ios::in | std::ios::binary | std::ios::ate);
+	if(!mStream.is_open())
+		return false;
+
+	// read it all in one go, everything after this is done in memory
+	mFileSize = (size_t)mStream.tellg();
+	mBuffer.resize(((headerSize != 0) && (headerSize < mFileSize)) ? headerSize : mFileSize);
+	mPos = 0;
+	mStream.seekg(0, std::ios::beg);
+	if(mBuffer.empty() || !mStream.read(&mBuffer[0], mBuffer.size()))
+		return false;
+
+	if(headerSize == 0)
+		mStream.close();
+
+	char fileMagic[4];
+	uint32_t fileVersion;
+	if(!read(&fileMagic) || memcmp(fileMagic, magic, sizeof(fileMagic)) || !read(&fileVersion) || fileVersion != version)
+	{
+		LOG(LogInfo) << "Ignoring outdated cache file \"" << path << "\"";
+		return false;
+	}
+
+	return true;
+}
+
+bool CacheReader::readToEnd(void* data, const size_t size)
+{
+	// the header has to be read up to its end, it's where the stream is
+	if(!mStream.is_open() || (mPos != mBuffer.size()) || (mBuffer.size() + size != mFileSize))
+		return false;
+
+	const bool read = (size == 0) || mStream.read((char*)data, size);
+	mStream.close();
+	return read;
+}
+
+bool CacheReader::readString(std::string* str)
+{
+	uint32_t size;
+	if(!read(&size) || mPos + size > mBuffer.size())
+		return false;
+
+	if(str)
+		str->assign(&mBuffer[mPos], size);
+
+	mPos += size;
+	return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef ES_CORE_CACHE_FILE_H
+#define ES_CORE_CACHE_FILE_H
+
+#include <fstream>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Binary files in ~/.emulationstation/cache/.
+// They are only ever read back by the machine that wrote them, so values are stored in native byte order.
+
+std::string getCacheFilePath(const std::string& name);
+
+class CacheWriter
+{
+public:
+	CacheWriter(const char magic[4], const uint32_t version);
+	CacheWriter(); // no header, only meant to be appended to another writer
+
+	template<typename T>
+	void write(const T value) { mBuffer.append((const char*)&value, sizeof(T)); }
+	void writeString(const std::string& str);
+	inline void writeBytes(const void* data, const size_t size) { mBuffer.append((const char*)data, size); }
+	inline void append(const CacheWriter& other) { mBuffer.append(other.mBuffer); }
+	inline size_t getSize() const { return mBuffer.size(); }
+
+	bool save(const std::string& path) const;
+
+private:
+	std::string mBuffer;
+};
+
+class CacheReader
+{
+public:
+	CacheReader();
+
+	// Returns false if the file doesn't exist or was written with another magic/version.
+	// With a headerSize only that many bytes are read, the rest is left for readToEnd().
+	bool load(const std::string& path, const char magic[4], const uint32_t version, const size_t headerSize = 0);
+
+	template<typename T>
+	bool read(T* value)
+	{
+		if(mPos + sizeof(T) > mBuffer.size())
+			return false;
+
+		memcpy(value, &mBuffer[mPos], sizeof(T));
+		mPos += sizeof(T);
+		return true;
+	}
+	bool readString(std::string* str); // a NULL str only skips over the string
+
+	inline bool readBytes(void* data, const size_t size)
+	{
+		if(mPos + size > mBuffer.size())
+			return false;
+
+		memcpy(data, &mBuffer[mPos], size);
+		mPos += size;
+		return true;
+	}
+
+	// Reads what follows the header straight from the file, returns false unless that is exactly size bytes
+	bool readToEnd(void* data, const size_t size);
+
+	inline bool atEnd() const { return mPos == mBuffer.size(); }
+	inline size_t getPos() const { return mPos; }
+	inline void setPos(const size_t pos) { mPos = pos; }
+
+private:
+	std::vector<char> mBuffer;
+	size_t mPos;
+	std::ifstream mStream; // only kept open after a load() with a headerSize
+	size_t mFileSize;
+};
+
+#endif // ES_CORE_CACHE_FILE_H
@@ -450,6 +450,36 @@ bool GuiComponent::isProcessing() const
 	return mIsProcessing;
 }
 
+bool GuiComponent::isChanging() const
+{
+	for(unsigned char i = 0; i < MAX_ANIMATIONS; i++)
+	{
+		if(mAnimationMap[i] != NULL)
+			return true;
+	}
+
+	for(unsigned int i = 0; i < getChildCount(); i++)
+	{
+		if(getChild(i)->isChanging())
+			return true;
+	}
+
+	return false;
+}
+
+int GuiComponent::getTimeUntilChange() const
+{
+	int time = -1;
+	for(unsigned int i = 0; i < getChildCount(); i++)
+	{
+		const int childTime = getChild(i)->getTimeUntilChange();
+		if(childTime >= 0 && (time < 0 || childTime < time))
+			time = childTime;
+	}
+
+	return time;
+}
+
 void GuiComponent::onShow()
 {
 	for(unsigned int i = 0; i < getChildCount(); i++)
@@ -134,6 +134,14 @@ public:
 	// Returns true if the component is busy doing background processing (e.g. HTTP downloads)
 	bool isProcessing() const;
 
+	// Returns true if the component or one of its children looks different from one update to the next without any input
+	// (animations, scrolling, videos...). Window doesn't render frames while nothing on screen is changing.
+	virtual bool isChanging() const;
+
+	// While it isn't changing: milliseconds until the component or one of its children starts changing on its own
+	// (a marquee waiting at its start...), -1 if only input changes it. Window sleeps that long for input at most.
+	virtual int getTimeUntilChange() const;
+
 protected:
 	void renderChildren(const Transform4x4f& transform) const;
 	void updateSelf(int deltaTime); // updates animations
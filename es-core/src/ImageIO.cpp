@@ -2,13 +2,61 @@
 
 #include "Log.h"
 #include <FreeImage.h>
+#include <algorithm>
 #include <string.h>
 
-std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define IMAGEIO_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define IMAGEIO_NEON
+#include <arm_neon.h>
+#endif
+
+void ImageIO::convertBGRAToRGBA(const unsigned char* src, unsigned char* dst, const size_t count, const bool vectorized)
 {
-	std::vector<unsigned char> rawData;
-	width = 0;
-	height = 0;
+	size_t i = 0;
+
+#if defined(IMAGEIO_SSE2)
+	// 4 pixels at a time, no SSSE3 shuffle so red and blue are swapped by shifting them within each 32 bit pixel
+	const __m128i maskGA = _mm_set1_epi32((int)0xFF00FF00);
+	const __m128i maskRB = _mm_set1_epi32(0x00FF00FF);
+	for(; vectorized && (i + 4 <= count); i += 4)
+	{
+		const __m128i bgra = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		const __m128i rb   = _mm_and_si128(bgra, maskRB);
+		const __m128i br   = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_or_si128(_mm_and_si128(bgra, maskGA), br));
+	}
+#elif defined(IMAGEIO_NEON)
+	// 16 pixels at a time, deinterleaved into one register per channel
+	for(; vectorized && (i + 16 <= count); i += 16)
+	{
+		uint8x16x4_t pixels = vld4q_u8(src + i * 4);
+		const uint8x16_t blue = pixels.val[0];
+		pixels.val[0] = pixels.val[2];
+		pixels.val[2] = blue;
+		vst4q_u8(dst + i * 4, pixels);
+	}
+#endif
+
+	// whatever is left, or everything on other machines or if it's not to be vectorized
+	for(; i < count; i++)
+	{
+		const unsigned char* px = src + i * 4;
+		unsigned char*       out = dst + i * 4;
+		const unsigned char  blue = px[0];
+		out[0] = px[2];
+		out[1] = px[1];
+		out[2] = blue;
+		out[3] = px[3];
+	}
+}
+
+// Decodes data into a 32 bit bitmap, NULL on failure
+static FIBITMAP* loadBitmap(const unsigned char* data, const size_t size)
+{
+	FIBITMAP* fiBitmap = nullptr;
 	FIMEMORY * fiMemory = FreeImage_OpenMemory((BYTE *)data, (DWORD)size);
 	if (fiMemory != nullptr) {
 		//detect the filetype from data
@@ -16,7 +64,7 @@ std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * d
 		if (format != FIF_UNKNOWN && FreeImage_FIFSupportsReading(format))
 		{
 			//file type is supported. load image
-			FIBITMAP * fiBitmap = FreeImage_LoadFromMemory(format, fiMemory);
+			fiBitmap = FreeImage_LoadFromMemory(format, fiMemory);
 			if (fiBitmap != nullptr)
 			{
 				//loaded. convert to 32bit if necessary
@@ -30,34 +78,6 @@ std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * d
 						fiBitmap = fiConverted;
 					}
 				}
-				if (fiBitmap != nullptr)
-				{
-					width = FreeImage_GetWidth(fiBitmap);
-					height = FreeImage_GetHeight(fiBitmap);
-					//loop through scanlines and add all pixel data to the return vector
-					//this is necessary, because width*height*bpp might not be == pitch
-					unsigned char * tempData = new unsigned char[width * height * 4];
-					for (size_t i = 0; i < height; i++)
-					{
-						const BYTE * scanLine = FreeImage_GetScanLine(fiBitmap, (int)i);
-						memcpy(tempData + (i * width * 4), scanLine, width * 4);
-					}
-					//convert from BGRA to RGBA
-					for(size_t i = 0; i < width*height; i++)
-					{
-						RGBQUAD bgra = ((RGBQUAD *)tempData)[i];
-						RGBQUAD rgba;
-						rgba.rgbBlue = bgra.rgbRed;
-						rgba.rgbGreen = bgra.rgbGreen;
-						rgba.rgbRed = bgra.rgbBlue;
-						rgba.rgbReserved = bgra.rgbReserved;
-						((RGBQUAD *)tempData)[i] = rgba;
-					}
-					rawData = std::vector<unsigned char>(tempData, tempData + width * height * 4);
-					//free bitmap data
-					FreeImage_Unload(fiBitmap);
-					delete[] tempData;
-				}
 			}
 			else
 			{
@@ -71,20 +91,246 @@ std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * d
 		//free FIMEMORY again
 		FreeImage_CloseMemory(fiMemory);
 	}
+	return fiBitmap;
+}
+
+// Converts the bitmap into dst in a single pass. FreeImage stores the bottom scanline first, flipVertically puts the top one first
+static void convertBitmap(FIBITMAP* fiBitmap, unsigned char* dst, const bool flipVertically)
+{
+	const size_t width = FreeImage_GetWidth(fiBitmap);
+	const size_t height = FreeImage_GetHeight(fiBitmap);
+
+	//go scanline by scanline, because width*height*bpp might not be == pitch
+	for (size_t i = 0; i < height; i++)
+	{
+		const BYTE * scanLine = FreeImage_GetScanLine(fiBitmap, (int)(flipVertically ? (height - 1 - i) : i));
+		ImageIO::convertBGRAToRGBA(scanLine, dst + (i * width * 4), width);
+	}
+}
+
+std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height, const bool flipVertically)
+{
+	std::vector<unsigned char> rawData;
+	width = 0;
+	height = 0;
+
+	FIBITMAP* fiBitmap = loadBitmap(data, size);
+	if (fiBitmap != nullptr)
+	{
+		width = FreeImage_GetWidth(fiBitmap);
+		height = FreeImage_GetHeight(fiBitmap);
+		rawData.resize(width * height * 4);
+		convertBitmap(fiBitmap, rawData.data(), flipVertically);
+		//free bitmap data
+		FreeImage_Unload(fiBitmap);
+	}
+	return rawData;
+}
+
+unsigned char* ImageIO::loadFromMemoryRGBA32Buffer(const unsigned char * data, const size_t size, size_t & width, size_t & height)
+{
+	unsigned char* rawData = nullptr;
+	width = 0;
+	height = 0;
+
+	FIBITMAP* fiBitmap = loadBitmap(data, size);
+	if (fiBitmap != nullptr)
+	{
+		width = FreeImage_GetWidth(fiBitmap);
+		height = FreeImage_GetHeight(fiBitmap);
+		if ((width != 0) && (height != 0))
+		{
+			rawData = new unsigned char[width * height * 4];
+			convertBitmap(fiBitmap, rawData, false);
+		}
+		//free bitmap data
+		FreeImage_Unload(fiBitmap);
+	}
 	return rawData;
 }
 
 void ImageIO::flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height)
 {
-	unsigned int temp;
-	unsigned int* arr = (unsigned int*)imagePx;
+	// swap whole rows, memcpy moves them far faster than a pixel at a time
+	const size_t rowSize = width * 4;
+	std::vector<unsigned char> temp(rowSize);
 	for(size_t y = 0; y < height / 2; y++)
 	{
-		for(size_t x = 0; x < width; x++)
+		unsigned char* top = imagePx + (y * rowSize);
+		unsigned char* bottom = imagePx + ((height - 1 - y) * rowSize);
+		memcpy(temp.data(), top, rowSize);
+		memcpy(top, bottom, rowSize);
+		memcpy(bottom, temp.data(), rowSize);
+	}
+}
+
+// Adds the source pixels of a row to the sums of the destination columns covering them
+static void sumRow(const unsigned char* srcRow, const std::vector<size_t>& colStart, unsigned int* sums, const size_t dstWidth, const bool vectorized)
+{
+#if defined(IMAGEIO_SSE2)
+	// all 4 channels of a pixel widened to 32 bit and summed in one register, 2 pixels per load
+	if(vectorized)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		for(size_t x = 0; x < dstWidth; x++)
+		{
+			const size_t colEnd = std::max<size_t>(colStart[x + 1], colStart[x] + 1);
+			__m128i sum = _mm_loadu_si128((const __m128i*)(sums + x * 4));
+			size_t sx = colStart[x];
+			for(; sx + 2 <= colEnd; sx += 2)
+			{
+				const __m128i px = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(srcRow + sx * 4)), zero);
+				sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_unpacklo_epi16(px, zero), _mm_unpackhi_epi16(px, zero)));
+			}
+			if(sx < colEnd)
+			{
+				int last;
+				memcpy(&last, srcRow + sx * 4, 4);
+				sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(last), zero), zero));
+			}
+			_mm_storeu_si128((__m128i*)(sums + x * 4), sum);
+		}
+		return;
+	}
+#elif defined(IMAGEIO_NEON)
+	// all 4 channels of a pixel widened to 32 bit and summed in one register, 2 pixels per load
+	if(vectorized)
+	{
+		for(size_t x = 0; x < dstWidth; x++)
+		{
+			const size_t colEnd = std::max<size_t>(colStart[x + 1], colStart[x] + 1);
+			uint32x4_t sum = vld1q_u32(sums + x * 4);
+			size_t sx = colStart[x];
+			for(; sx + 2 <= colEnd; sx += 2)
+			{
+				const uint16x8_t px = vmovl_u8(vld1_u8(srcRow + sx * 4));
+				sum = vaddw_u16(vaddw_u16(sum, vget_low_u16(px)), vget_high_u16(px));
+			}
+			if(sx < colEnd)
+			{
+				uint32_t last;
+				memcpy(&last, srcRow + sx * 4, 4);
+				sum = vaddw_u16(sum, vget_low_u16(vmovl_u8(vcreate_u8(last))));
+			}
+			vst1q_u32(sums + x * 4, sum);
+		}
+		return;
+	}
+#endif
+
+	// on other machines or if it's not to be vectorized
+	for(size_t x = 0; x < dstWidth; x++)
+	{
+		const size_t colEnd = std::max<size_t>(colStart[x + 1], colStart[x] + 1);
+		unsigned int* sum = sums + x * 4;
+		for(size_t sx = colStart[x]; sx < colEnd; sx++)
 		{
-			temp = arr[x + (y * width)];
-			arr[x + (y * width)] = arr[x + (height * width) - ((y + 1) * width)];
-			arr[x + (height * width) - ((y + 1) * width)] = temp;
+			sum[0] += srcRow[sx * 4 + 0];
+			sum[1] += srcRow[sx * 4 + 1];
+			sum[2] += srcRow[sx * 4 + 2];
+			sum[3] += srcRow[sx * 4 + 3];
 		}
 	}
 }
+
+void ImageIO::shrinkRGBA32(const unsigned char* src, const size_t srcWidth, const size_t srcHeight, unsigned char* dst, const size_t dstWidth, const size_t dstHeight, const bool vectorized)
+{
+	// the source columns each destination column covers, the same for every row
+	std::vector<size_t> colStart(dstWidth + 1);
+	for(size_t x = 0; x <= dstWidth; x++)
+		colStart[x] = (x * srcWidth) / dstWidth;
+
+	std::vector<unsigned int> sums(dstWidth * 4);
+
+	for(size_t y = 0; y < dstHeight; y++)
+	{
+		const size_t rowStart = (y * srcHeight) / dstHeight;
+		const size_t rowEnd   = std::max<size_t>(((y + 1) * srcHeight) / dstHeight, rowStart + 1);
+
+		// sum up the covered rows first, so each source pixel is read exactly once
+		std::fill(sums.begin(), sums.end(), 0);
+		for(size_t sy = rowStart; sy < rowEnd; sy++)
+			sumRow(src + (sy * srcWidth * 4), colStart, sums.data(), dstWidth, vectorized);
+
+		unsigned char* dstRow = dst + (y * dstWidth * 4);
+		for(size_t x = 0; x < dstWidth; x++)
+		{
+			const unsigned int count = (unsigned int)((rowEnd - rowStart) * (std::max<size_t>(colStart[x + 1], colStart[x] + 1) - colStart[x]));
+			for(int c = 0; c < 4; c++)
+				dstRow[x * 4 + c] = (unsigned char)((sums[x * 4 + c] + count / 2) / count);
+		}
+	}
+}
+
+static inline unsigned int readBE16(const unsigned char* p) { return (p[0] << 8) | p[1]; }
+static inline unsigned int readLE16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+static inline unsigned int readBE32(const unsigned char* p) { return ((unsigned int)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+static inline int          readLE32(const unsigned char* p) { return (int)(p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24)); }
+
+bool ImageIO::getImageSize(const unsigned char* data, const size_t size, size_t& width, size_t& height)
+{
+	width = 0;
+	height = 0;
+
+	// PNG: signature, then the IHDR chunk, which has to come first
+	if(size >= 24 && !memcmp(data, "\x89PNG\r\n\x1a\n", 8) && !memcmp(data + 12, "IHDR", 4))
+	{
+		width  = readBE32(data + 16);
+		height = readBE32(data + 20);
+	}
+	// GIF: logical screen size right after the signature
+	else if(size >= 10 && (!memcmp(data, "GIF87a", 6) || !memcmp(data, "GIF89a", 6)))
+	{
+		width  = readLE16(data + 6);
+		height = readLE16(data + 8);
+	}
+	// BMP: info header, the height is negative for top-down bitmaps
+	else if(size >= 26 && data[0] == 'B' && data[1] == 'M')
+	{
+		width  = (size_t)abs(readLE32(data + 18));
+		height = (size_t)abs(readLE32(data + 22));
+	}
+	// JPEG: walk the segments up to the first start of frame
+	else if(size >= 4 && data[0] == 0xFF && data[1] == 0xD8)
+	{
+		size_t pos = 2;
+		while(pos + 4 <= size)
+		{
+			if(data[pos] != 0xFF)
+				return false;
+
+			const unsigned char marker = data[pos + 1];
+
+			// fill bytes and standalone markers carry no length
+			if(marker == 0xFF)
+			{
+				pos += 1;
+				continue;
+			}
+			if(marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8))
+			{
+				pos += 2;
+				continue;
+			}
+
+			// SOF0-SOF15, except DHT (C4), JPG (C8) and DAC (CC)
+			if(marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+			{
+				if(pos + 9 > size)
+					return false;
+
+				height = readBE16(data + pos + 5);
+				width  = readBE16(data + pos + 7);
+				break;
+			}
+
+			// start of scan or end of image before any frame, give up
+			if(marker == 0xDA || marker == 0xD9)
+				return false;
+
+			pos += 2 + readBE16(data + pos + 2);
+		}
+	}
+
+	return (width != 0) && (height != 0);
+}
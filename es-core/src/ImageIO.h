@@ -8,8 +8,23 @@
 class ImageIO
 {
 public:
-	static std::vector<unsigned char> loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height);
+	// Decodes an image into RGBA32 pixels, the bottom row first unless flipVertically is set
+	static std::vector<unsigned char> loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height, const bool flipVertically = false);
+	// As above, but into a new[] allocated buffer the caller takes ownership of. Returns nullptr on failure
+	static unsigned char* loadFromMemoryRGBA32Buffer(const unsigned char * data, const size_t size, size_t & width, size_t & height);
 	static void flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height);
+
+	// FreeImage keeps 32 bit pixels as BGRA on little endian machines, swaps blue and red of count pixels from src into dst.
+	// Uses SSE2 or NEON where available, unless vectorized is false (only there to compare them)
+	static void convertBGRAToRGBA(const unsigned char* src, unsigned char* dst, const size_t count, const bool vectorized = true);
+
+	// Downscales an RGBA32 image with a box filter, every destination pixel is the average of the source pixels it covers.
+	// The sums use SSE2 or NEON where available, unless vectorized is false (only there to compare them)
+	static void shrinkRGBA32(const unsigned char* src, const size_t srcWidth, const size_t srcHeight, unsigned char* dst, const size_t dstWidth, const size_t dstHeight, const bool vectorized = true);
+
+	// Reads the dimensions of a PNG, JPEG, GIF or BMP image from its header, without decoding any pixels.
+	// data may be only the start of the file, returns false if the dimensions aren't in it or the format is unknown.
+	static bool getImageSize(const unsigned char* data, const size_t size, size_t& width, size_t& height);
 };
 
 #endif // ES_CORE_IMAGE_IO
@@ -2,6 +2,7 @@
 
 #include "resources/ResourceManager.h"
 #include "utils/FileSystemUtil.h"
+#include "CacheFile.h"
 #include "Log.h"
 #include <pugixml/src/pugixml.hpp>
 #include <string.h>
@@ -34,74 +35,80 @@ MameNames* MameNames::getInstance()
 
 } // getInstance
 
+// bump this whenever the layout below changes, old tables are then simply ignored
+static const char     CACHE_MAGIC[4] = { 'E', 'S', 'M', 'N' };
+static const uint32_t CACHE_VERSION  = 2;
+
+// per xml file: path, size, mtime; then the name pairs, the bioses and the devices, each prefixed by their count
+
 MameNames::MameNames()
 {
-	std::string xmlpath = ResourceManager::getInstance()->getResourcePath(":/mamenames.xml");
+	const std::string xmlPaths[3] =
+	{
+		ResourceManager::getInstance()->getResourcePath(":/mamenames.xml"),
+		ResourceManager::getInstance()->getResourcePath(":/mamebioses.xml"),
+		ResourceManager::getInstance()->getResourcePath(":/mamedevices.xml")
+	};
 
-	if(!Utils::FileSystem::exists(xmlpath))
+	// the compiled tables are used as long as none of the xml files changed since they were written
+	if(loadCache(xmlPaths))
 		return;
 
-	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
-
 	pugi::xml_document doc;
-	pugi::xml_parse_result result = doc.load_file(xmlpath.c_str());
+	pugi::xml_parse_result result;
 
-	if(!result)
+	if(Utils::FileSystem::exists(xmlPaths[0]))
 	{
-		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
-		return;
-	}
+		LOG(LogInfo) << "Parsing XML file \"" << xmlPaths[0] << "\"...";
 
-	for(pugi::xml_node gameNode = doc.child("game"); gameNode; gameNode = gameNode.next_sibling("game"))
-	{
-		NamePair namePair = { gameNode.child("mamename").text().get(), gameNode.child("realname").text().get() };
-		mNamePairs.push_back(namePair);
+		result = doc.load_file(xmlPaths[0].c_str());
+
+		if(!result)
+		{
+			LOG(LogError) << "Error parsing XML file \"" << xmlPaths[0] << "\"!\n	" << result.description();
+			return;
+		}
+
+		for(pugi::xml_node gameNode = doc.child("game"); gameNode; gameNode = gameNode.next_sibling("game"))
+			mNamePairs[gameNode.child("mamename").text().get()] = gameNode.child("realname").text().get();
 	}
-	
+
 	// Read bios
-	xmlpath = ResourceManager::getInstance()->getResourcePath(":/mamebioses.xml");
- 	
-	if(!Utils::FileSystem::exists(xmlpath))
-		return;
- 	
-	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
- 	
-	result = doc.load_file(xmlpath.c_str());
- 	
-	if(!result)
-	{
-		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
-		return;
-	}
- 	
-	for(pugi::xml_node biosNode = doc.child("bios"); biosNode; biosNode = biosNode.next_sibling("bios"))
+	if(Utils::FileSystem::exists(xmlPaths[1]))
 	{
-		std::string bios = biosNode.text().get();
-		mMameBioses.push_back(bios);
+		LOG(LogInfo) << "Parsing XML file \"" << xmlPaths[1] << "\"...";
+
+		result = doc.load_file(xmlPaths[1].c_str());
+
+		if(!result)
+		{
+			LOG(LogError) << "Error parsing XML file \"" << xmlPaths[1] << "\"!\n	" << result.description();
+			return;
+		}
+
+		for(pugi::xml_node biosNode = doc.child("bios"); biosNode; biosNode = biosNode.next_sibling("bios"))
+			mMameBioses.insert(biosNode.text().get());
 	}
-	
+
 	// Read devices
-	xmlpath = ResourceManager::getInstance()->getResourcePath(":/mamedevices.xml");
- 	
-	if(!Utils::FileSystem::exists(xmlpath))
-		return;
- 	
-	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
- 	
-	result = doc.load_file(xmlpath.c_str());
- 	
-	if(!result)
-	{
-		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
-		return;
-	}
- 	
-	for(pugi::xml_node deviceNode = doc.child("device"); deviceNode; deviceNode = deviceNode.next_sibling("device"))
+	if(Utils::FileSystem::exists(xmlPaths[2]))
 	{
-		std::string device = deviceNode.text().get();
-		mMameDevices.push_back(device);
+		LOG(LogInfo) << "Parsing XML file \"" << xmlPaths[2] << "\"...";
+
+		result = doc.load_file(xmlPaths[2].c_str());
+
+		if(!result)
+		{
+			LOG(LogError) << "Error parsing XML file \"" << xmlPaths[2] << "\"!\n	" << result.description();
+			return;
+		}
+
+		for(pugi::xml_node deviceNode = doc.child("device"); deviceNode; deviceNode = deviceNode.next_sibling("device"))
+			mMameDevices.insert(deviceNode.text().get());
 	}
 
+	saveCache(xmlPaths);
+
 } // MameNames
 
 MameNames::~MameNames()
@@ -109,52 +116,109 @@ MameNames::~MameNames()
 
 } // ~MameNames
 
-std::string MameNames::getRealName(const std::string& _mameName)
+bool MameNames::loadCache(const std::string _xmlPaths[3])
+{
+	CacheReader reader;
+	if(!reader.load(getCacheFilePath("mamenames.bin"), CACHE_MAGIC, CACHE_VERSION))
+		return false;
+
+	for(int i = 0; i < 3; i++)
+	{
+		std::string path;
+		int64_t     size;
+		int64_t     time;
+
+		if(!reader.readString(&path) || path != _xmlPaths[i] ||
+		   !reader.read(&size) || size != (int64_t)Utils::FileSystem::getFileSize(path) ||
+		   !reader.read(&time) || time != (int64_t)Utils::FileSystem::getModifiedTimeNs(path))
+			return false;
+	}
+
+	uint32_t count;
+	bool     valid = reader.read(&count);
+
+	for(uint32_t i = 0; valid && i < count; i++)
+	{
+		std::string mameName;
+		std::string realName;
+		valid = reader.readString(&mameName) && reader.readString(&realName);
+		mNamePairs[mameName] = realName;
+	}
+
+	std::unordered_set<std::string>* sets[2] = { &mMameBioses, &mMameDevices };
+	for(int i = 0; i < 2; i++)
+	{
+		valid = valid && reader.read(&count);
+
+		for(uint32_t j = 0; valid && j < count; j++)
+		{
+			std::string name;
+			valid = reader.readString(&name);
+			sets[i]->insert(name);
+		}
+	}
+
+	if(!valid || !reader.atEnd())
+	{
+		LOG(LogWarning) << "MAME name tables are corrupt, parsing the XML files again";
+		mNamePairs.clear();
+		mMameBioses.clear();
+		mMameDevices.clear();
+		return false;
+	}
+
+	return true;
+
+} // loadCache
+
+void MameNames::saveCache(const std::string _xmlPaths[3])
 {
-	size_t start = 0;
-	size_t end   = mNamePairs.size();
+	CacheWriter writer(CACHE_MAGIC, CACHE_VERSION);
 
-	while(start < end)
+	for(int i = 0; i < 3; i++)
 	{
-		const size_t index   = (start + end) / 2;
-		const int    compare = strcmp(mNamePairs[index].mameName.c_str(), _mameName.c_str());
+		writer.writeString(_xmlPaths[i]);
+		writer.write((int64_t)Utils::FileSystem::getFileSize(_xmlPaths[i]));
+		writer.write((int64_t)Utils::FileSystem::getModifiedTimeNs(_xmlPaths[i]));
+	}
 
-		if(compare < 0)       start = index + 1;
-		else if( compare > 0) end   = index;
-		else                  return mNamePairs[index].realName;
+	writer.write((uint32_t)mNamePairs.size());
+	for(auto it = mNamePairs.cbegin(); it != mNamePairs.cend(); ++it)
+	{
+		writer.writeString(it->first);
+		writer.writeString(it->second);
 	}
 
+	const std::unordered_set<std::string>* sets[2] = { &mMameBioses, &mMameDevices };
+	for(int i = 0; i < 2; i++)
+	{
+		writer.write((uint32_t)sets[i]->size());
+		for(auto it = sets[i]->cbegin(); it != sets[i]->cend(); ++it)
+			writer.writeString(*it);
+	}
+
+	writer.save(getCacheFilePath("mamenames.bin"));
+
+} // saveCache
+
+std::string MameNames::getRealName(const std::string& _mameName)
+{
+	auto it = mNamePairs.find(_mameName);
+	if(it != mNamePairs.cend())
+		return it->second;
+
 	return _mameName;
 
 } // getRealName
 
 const bool MameNames::isBios(const std::string& _biosName)
 {
-	return MameNames::find(mMameBioses, _biosName);
+	return mMameBioses.find(_biosName) != mMameBioses.cend();
 
 } // isBios
 
 const bool MameNames::isDevice(const std::string& _deviceName)
 {
-	return MameNames::find(mMameDevices, _deviceName);
-	
-} // isDevice
+	return mMameDevices.find(_deviceName) != mMameDevices.cend();
 
-const bool MameNames::find(std::vector<std::string> devices, const std::string& name)
-{
-	size_t start = 0;
-	size_t end   = devices.size();
-
-	while(start < end)
-	{
-		const size_t index   = (start + end) / 2;
-		const int    compare = strcmp(devices[index].c_str(), name.c_str());
-
-		if(compare < 0)       start = index + 1;
-		else if( compare > 0) end   = index;
-		else                  return true;
-	}
-
-	return false;
-	
-}
+} // isDevice
@@ -3,7 +3,8 @@
 #define ES_CORE_MAMENAMES_H
 
 #include <string>
-#include <vector>
+#include <unordered_map>
+#include <unordered_set>
 
 class MameNames
 {
@@ -18,24 +19,17 @@ public:
 
 private:
 
-	struct NamePair
-	{
-		std::string mameName;
-		std::string realName;
-	};
-
-	typedef std::vector<NamePair> namePairVector;
-
 	 MameNames();
 	~MameNames();
 
+	bool loadCache(const std::string _xmlPaths[3]);
+	void saveCache(const std::string _xmlPaths[3]);
+
 	static MameNames* sInstance;
 
-	namePairVector mNamePairs;
-	std::vector<std::string> mMameBioses;
-	std::vector<std::string> mMameDevices;
-	
-	const bool find(const std::vector<std::string> devices, const std::string& name);
+	std::unordered_map<std::string, std::string> mNamePairs;
+	std::unordered_set<std::string>              mMameBioses;
+	std::unordered_set<std::string>              mMameDevices;
 
 }; // MameNames
 
@@ -0,0 +1,189 @@
+#include "Profiler.h"
+
+#include "Log.h"
+#include <algorithm>
+#include <fstream>
+
+#define BUCKET_SIZE  100 // microseconds
+#define BUCKET_COUNT 1001
+
+std::atomic<bool> Profiler::sRunning(false);
+bool Profiler::sTracing = false;
+std::mutex Profiler::sMutex;
+
+std::chrono::steady_clock::time_point Profiler::sStartTime;
+std::chrono::steady_clock::time_point Profiler::sFrameStart;
+bool Profiler::sFrameStarted = false;
+
+Profiler::Histogram Profiler::sFrameHistogram;
+std::map<std::string, Profiler::Histogram> Profiler::sScopeHistograms;
+
+std::vector<Profiler::TraceEvent> Profiler::sTraceEvents;
+size_t Profiler::sTraceNext = 0;
+std::map<std::thread::id, unsigned int> Profiler::sThreadIds;
+
+Profiler::Histogram::Histogram() : mBuckets(BUCKET_COUNT, 0), mCount(0)
+{
+}
+
+void Profiler::Histogram::add(long long microseconds)
+{
+	const long long bucket = std::min(std::max(microseconds, 0LL) / BUCKET_SIZE, (long long)(BUCKET_COUNT - 1));
+	mBuckets[(size_t)bucket]++;
+	mCount++;
+}
+
+float Profiler::Histogram::getPercentile(float percentile) const
+{
+	if(mCount == 0)
+		return 0.0f;
+
+	// the upper edge of the bucket the percentile falls into
+	const unsigned int rank = std::max((unsigned int)(percentile * mCount + 0.999f), 1u);
+	unsigned int count = 0;
+	for(size_t i = 0; i < mBuckets.size(); i++)
+	{
+		count += mBuckets[i];
+		if(count >= rank)
+			return (float)((i + 1) * BUCKET_SIZE) / 1000.0f;
+	}
+
+	return (float)(BUCKET_COUNT * BUCKET_SIZE) / 1000.0f;
+}
+
+Profiler::Scope::Scope(const char* name) : mName(name), mRunning(Profiler::isRunning())
+{
+	if(mRunning)
+		mStart = std::chrono::steady_clock::now();
+}
+
+Profiler::Scope::~Scope()
+{
+	if(mRunning)
+		Profiler::add(mName, mStart, std::chrono::steady_clock::now(), false);
+}
+
+void Profiler::start(bool trace)
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	if(!sRunning)
+		sStartTime = std::chrono::steady_clock::now();
+
+	sTracing = sTracing || trace;
+	sRunning = true;
+}
+
+void Profiler::stop()
+{
+	sRunning = false;
+}
+
+void Profiler::beginFrame()
+{
+	if(!sRunning)
+		return;
+
+	sFrameStart = std::chrono::steady_clock::now();
+	sFrameStarted = true;
+}
+
+void Profiler::endFrame()
+{
+	if(!sRunning || !sFrameStarted)
+		return;
+
+	sFrameStarted = false;
+	add("Frame", sFrameStart, std::chrono::steady_clock::now(), true);
+}
+
+float Profiler::getFrameTime(float percentile)
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+	return sFrameHistogram.getPercentile(percentile);
+}
+
+void Profiler::add(const char* name, const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::time_point& end, bool frame)
+{
+	const long long duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	if(frame)
+		sFrameHistogram.add(duration);
+	else
+		sScopeHistograms[name].add(duration);
+
+	if(!sTracing)
+		return;
+
+	TraceEvent event;
+	event.name = name;
+	event.start = std::chrono::duration_cast<std::chrono::microseconds>(start - sStartTime).count();
+	event.duration = duration;
+	event.thread = getThreadId();
+
+	// once full, the oldest event makes room
+	if(sTraceEvents.size() < MAX_TRACE_EVENTS)
+	{
+		sTraceEvents.push_back(event);
+	}else{
+		sTraceEvents[sTraceNext] = event;
+		sTraceNext = (sTraceNext + 1) % MAX_TRACE_EVENTS;
+	}
+}
+
+unsigned int Profiler::getThreadId()
+{
+	const std::thread::id id = std::this_thread::get_id();
+
+	auto it = sThreadIds.find(id);
+	if(it != sThreadIds.cend())
+		return it->second;
+
+	const unsigned int threadId = (unsigned int)sThreadIds.size();
+	sThreadIds[id] = threadId;
+	return threadId;
+}
+
+bool Profiler::writeTrace(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if(!file.is_open())
+	{
+		LOG(LogError) << "Could not write profiler trace \"" << path << "\"";
+		return false;
+	}
+
+	// complete events ("X") carry their own duration, the names are literals that need no escaping
+	file << "{\"traceEvents\":[\n";
+	for(size_t i = 0; i < sTraceEvents.size(); i++)
+	{
+		const TraceEvent& event = sTraceEvents[(sTraceNext + i) % sTraceEvents.size()];
+		file << "{\"name\":\"" << event.name << "\",\"cat\":\"es\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread <<
+			",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}" << ((i + 1 < sTraceEvents.size()) ? ",\n" : "\n");
+	}
+	file << "],\"displayTimeUnit\":\"ms\"}\n";
+
+	if(!file.good())
+		return false;
+
+	LOG(LogInfo) << "Profiler trace of " << sTraceEvents.size() << " events written to \"" << path << "\"";
+	return true;
+}
+
+void Profiler::logSummary()
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	LOG(LogInfo) << "Profiler: frames, " << sFrameHistogram.getCount() << " times, p50 " << sFrameHistogram.getPercentile(0.5f) <<
+		"ms, p95 " << sFrameHistogram.getPercentile(0.95f) << "ms, p99 " << sFrameHistogram.getPercentile(0.99f) << "ms";
+
+	for(auto it = sScopeHistograms.cbegin(); it != sScopeHistograms.cend(); it++)
+	{
+		LOG(LogInfo) << "Profiler: " << it->first << ", " << it->second.getCount() << " times, p50 " << it->second.getPercentile(0.5f) <<
+			"ms, p95 " << it->second.getPercentile(0.95f) << "ms, p99 " << it->second.getPercentile(0.99f) << "ms";
+	}
+}
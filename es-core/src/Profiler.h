@@ -0,0 +1,102 @@
+#pragma once
+#ifndef ES_CORE_PROFILER_H
+#define ES_CORE_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Times the rest of the enclosing block under the given name, as long as the profiler is running
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_SCOPE_JOIN(profileScope, __LINE__)(name)
+#define PROFILE_SCOPE_JOIN(a, b) PROFILE_SCOPE_JOIN_LINE(a, b)
+#define PROFILE_SCOPE_JOIN_LINE(a, b) a##b
+
+// Collects how long frames and named scopes take. Every frame and scope goes into a histogram for its p50/p95/p99,
+// and when tracing also into a trace that chrome://tracing can load, so single slow frames can be looked into.
+// Scopes can be timed on any thread. While the profiler isn't running a scope costs one atomic load.
+class Profiler
+{
+public:
+	class Scope
+	{
+	public:
+		Scope(const char* name);
+		~Scope();
+
+	private:
+		const char* mName; // has to outlive the profiler, a string literal
+		std::chrono::steady_clock::time_point mStart;
+		bool mRunning;
+	};
+
+	// With trace, every frame and scope is kept for writeTrace() as well, the most recent MAX_TRACE_EVENTS of them
+	static void start(bool trace);
+	static void stop();
+	static bool isRunning() { return sRunning; }
+
+	// A frame lasts from beginFrame() to endFrame(), a frame that never ends (because it was skipped) isn't counted
+	static void beginFrame();
+	static void endFrame();
+
+	// Milliseconds that the given share of frames, in [0, 1], took at most
+	static float getFrameTime(float percentile);
+
+	// Writes the trace as Chrome trace event JSON, returns false if the file couldn't be written
+	static bool writeTrace(const std::string& path);
+
+	// Logs the percentiles of the frames and of every scope
+	static void logSummary();
+
+	static const size_t MAX_TRACE_EVENTS = 200000;
+
+private:
+	// 0.1ms buckets up to 100ms, anything longer goes into the last one
+	class Histogram
+	{
+	public:
+		Histogram();
+
+		void add(long long microseconds);
+		float getPercentile(float percentile) const; // in milliseconds
+		unsigned int getCount() const { return mCount; }
+
+	private:
+		std::vector<unsigned int> mBuckets;
+		unsigned int mCount;
+	};
+
+	struct TraceEvent
+	{
+		const char* name;
+		long long start; // microseconds since start()
+		long long duration;
+		unsigned int thread;
+	};
+
+	// A frame goes into sFrameHistogram, a scope into the histogram of its name
+	static void add(const char* name, const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::time_point& end, bool frame);
+
+	// Small numbers for the trace, in the order the threads first showed up. sMutex has to be held
+	static unsigned int getThreadId();
+
+	static std::atomic<bool> sRunning;
+	static bool sTracing;
+	static std::mutex sMutex;
+
+	static std::chrono::steady_clock::time_point sStartTime;
+	static std::chrono::steady_clock::time_point sFrameStart;
+	static bool sFrameStarted;
+
+	static Histogram sFrameHistogram;
+	static std::map<std::string, Histogram> sScopeHistograms;
+
+	static std::vector<TraceEvent> sTraceEvents;
+	static size_t sTraceNext; // where the next event goes once the trace is full
+	static std::map<std::thread::id, unsigned int> sThreadIds;
+};
+
+#endif // ES_CORE_PROFILER_H
@@ -2,6 +2,7 @@
 #ifndef ES_CORE_RENDERER_H
 #define ES_CORE_RENDERER_H
 
+#include "math/Vector2f.h"
 #include "math/Vector2i.h"
 #include "platform.h"
 #include GLHEADER
@@ -18,6 +19,9 @@ namespace Renderer
 	bool init();
 	void deinit();
 
+	//true when started with --headless: no window or GL context is created, draws and texture uploads are only counted
+	bool isHeadless();
+
 	unsigned int getWindowWidth();
 	unsigned int getWindowHeight();
 	unsigned int getScreenWidth();
@@ -38,6 +42,47 @@ namespace Renderer
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
 	void drawRect(float x, float y, float w, float h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
+
+	//batched drawing, everything is drawn through this (Renderer_batch_gl.cpp)
+	//draws are transformed by the current matrix and queued. a draw joins an earlier batch with the same texture, blending and
+	//primitive as long as it doesn't overlap anything queued after that batch, so the order things end up on screen is kept.
+	//the queue is flushed when the clip rect changes, before a texture is deleted and before the buffers are swapped.
+	struct Vertex
+	{
+		Vector2f pos;
+		Vector2f tex;
+	};
+
+	//sets the texture of the following draws, 0 = untextured
+	void bindTexture(GLuint texture);
+	//colors has 4 bytes per vertex, as built by buildGLColorArray. GL_ONE, GL_ZERO draws without blending
+	void drawTriangles(const Vertex* vertices, const GLubyte* colors, unsigned int count, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
+	void drawLines(const Vertex* vertices, const GLubyte* colors, unsigned int count);
+	void flush();
+	//flushes and rolls the frame statistics over, called by swapBuffers()
+	void endFrame();
+
+	//textures are created, updated and deleted through here so they are counted, and so the headless backend can skip GL
+	//linear only picks the minification filter, magnification is always nearest. format is GL_RGBA or GL_ALPHA
+	GLuint createTexture(unsigned int width, unsigned int height, GLenum format, bool linear, bool repeat, const void* data);
+	void updateTexture(GLuint texture, int x, int y, unsigned int width, unsigned int height, GLenum format, const void* data);
+	//flushes first, draws waiting in the queue may still use it
+	void destroyTexture(GLuint texture);
+
+	struct FrameStats
+	{
+		unsigned int draws;          //draws queued by components
+		unsigned int vertices;       //vertices in those
+		unsigned int drawCalls;      //glDrawArrays calls they were flushed with
+		unsigned int stateChanges;   //texture and blending switches between those
+		unsigned int textureUploads; //whole textures and parts of them
+		size_t       uploadedBytes;
+		unsigned int texturesCreated;
+		unsigned int texturesDeleted;
+	};
+
+	//statistics of the last complete frame
+	const FrameStats& getFrameStats();
 }
 
 #endif // ES_CORE_RENDERER_H
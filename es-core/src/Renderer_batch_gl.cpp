@@ -0,0 +1,284 @@
+#include "Renderer.h"
+
+#include "math/Transform4x4f.h"
+#include <algorithm>
+#include <vector>
+
+namespace Renderer {
+	//how many batches back a draw may be moved to join one with the same state
+	static const unsigned int BATCH_LOOKBACK = 8;
+
+	struct BatchVertex {
+		GLfloat x;
+		GLfloat y;
+		GLfloat u;
+		GLfloat v;
+		GLubyte color[4];
+	};
+
+	struct Batch {
+		GLenum mode;
+		GLuint texture;
+		GLenum blendSrc;
+		GLenum blendDst;
+		std::vector<BatchVertex> vertices;
+		//screen space bounds of everything in it
+		float minX;
+		float minY;
+		float maxX;
+		float maxY;
+	};
+
+	static Transform4x4f currentMatrix = Transform4x4f::Identity();
+	static GLuint currentTexture = 0;
+
+	//batches are reused frame after frame so their vertex buffers keep their capacity
+	static std::vector<Batch> batches;
+	static unsigned int batchCount = 0;
+	static std::vector<BatchVertex> transformed;
+
+	static FrameStats frameStats = FrameStats();
+	static FrameStats lastFrameStats = FrameStats();
+
+	//handed out instead of GL names when headless
+	static GLuint nextHeadlessTexture = 1;
+
+	void setMatrix(const Transform4x4f& matrix)
+	{
+		//the GL modelview matrix stays the identity, vertices are transformed when they are queued
+		currentMatrix = matrix;
+	}
+
+	void bindTexture(GLuint texture)
+	{
+		currentTexture = texture;
+	}
+
+	static void queue(GLenum mode, const Vertex* vertices, const GLubyte* colors, unsigned int count, GLenum blendSrc, GLenum blendDst)
+	{
+		if(count == 0)
+			return;
+
+		frameStats.draws++;
+		frameStats.vertices += count;
+
+		//transform to screen space first, the bounds decide which batch it may join
+		const float* m = (const float*)&currentMatrix;
+		transformed.resize(count);
+		float minX = 0, minY = 0, maxX = 0, maxY = 0;
+		for(unsigned int i = 0; i < count; i++)
+		{
+			BatchVertex& out = transformed[i];
+			const Vector2f& pos = vertices[i].pos;
+			out.x = m[0] * pos.x() + m[4] * pos.y() + m[12];
+			out.y = m[1] * pos.x() + m[5] * pos.y() + m[13];
+			out.u = vertices[i].tex.x();
+			out.v = vertices[i].tex.y();
+			out.color[0] = colors[i * 4 + 0];
+			out.color[1] = colors[i * 4 + 1];
+			out.color[2] = colors[i * 4 + 2];
+			out.color[3] = colors[i * 4 + 3];
+
+			if(i == 0)
+			{
+				minX = maxX = out.x;
+				minY = maxY = out.y;
+			}else{
+				minX = std::min(minX, out.x);
+				minY = std::min(minY, out.y);
+				maxX = std::max(maxX, out.x);
+				maxY = std::max(maxY, out.y);
+			}
+		}
+
+		//look for a batch with the same state it can be moved back to, it can't pass anything it overlaps
+		Batch* target = NULL;
+		for(unsigned int i = batchCount; (i > 0) && ((batchCount - i) < BATCH_LOOKBACK); i--)
+		{
+			Batch& batch = batches[i - 1];
+			if(batch.mode == mode && batch.texture == currentTexture && batch.blendSrc == blendSrc && batch.blendDst == blendDst)
+			{
+				target = &batch;
+				break;
+			}
+
+			if(minX <= batch.maxX && maxX >= batch.minX && minY <= batch.maxY && maxY >= batch.minY)
+				break;
+		}
+
+		if(target == NULL)
+		{
+			if(batchCount == batches.size())
+				batches.push_back(Batch());
+
+			target = &batches[batchCount++];
+			target->mode = mode;
+			target->texture = currentTexture;
+			target->blendSrc = blendSrc;
+			target->blendDst = blendDst;
+			target->vertices.clear();
+			target->minX = minX;
+			target->minY = minY;
+			target->maxX = maxX;
+			target->maxY = maxY;
+		}else{
+			target->minX = std::min(target->minX, minX);
+			target->minY = std::min(target->minY, minY);
+			target->maxX = std::max(target->maxX, maxX);
+			target->maxY = std::max(target->maxY, maxY);
+		}
+
+		target->vertices.insert(target->vertices.end(), transformed.cbegin(), transformed.cend());
+	}
+
+	void drawTriangles(const Vertex* vertices, const GLubyte* colors, unsigned int count, GLenum blend_sfactor, GLenum blend_dfactor)
+	{
+		queue(GL_TRIANGLES, vertices, colors, count, blend_sfactor, blend_dfactor);
+	}
+
+	void drawLines(const Vertex* vertices, const GLubyte* colors, unsigned int count)
+	{
+		bindTexture(0);
+		queue(GL_LINES, vertices, colors, count, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	static void submit(const Batch& batch, bool textureChanged, bool blendChanged)
+	{
+		if(textureChanged)
+		{
+			if(batch.texture != 0)
+			{
+				glEnable(GL_TEXTURE_2D);
+				glBindTexture(GL_TEXTURE_2D, batch.texture);
+			}else{
+				glDisable(GL_TEXTURE_2D);
+			}
+		}
+
+		if(blendChanged)
+		{
+			if(batch.blendSrc == GL_ONE && batch.blendDst == GL_ZERO)
+			{
+				glDisable(GL_BLEND);
+			}else{
+				glEnable(GL_BLEND);
+				glBlendFunc(batch.blendSrc, batch.blendDst);
+			}
+		}
+
+		glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), &batch.vertices[0].x);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(BatchVertex), &batch.vertices[0].u);
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BatchVertex), &batch.vertices[0].color);
+
+		glDrawArrays(batch.mode, 0, (GLsizei)batch.vertices.size());
+	}
+
+	void flush()
+	{
+		if(batchCount == 0)
+			return;
+
+		//the headless backend only counts what would have been sent to GL
+		const bool useGL = !isHeadless();
+
+		if(useGL)
+		{
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+		}
+
+		//textures may have been bound for uploads since the last flush, so the first batch always sets its state
+		for(unsigned int i = 0; i < batchCount; i++)
+		{
+			const Batch& batch = batches[i];
+			const Batch* previous = (i > 0) ? &batches[i - 1] : NULL;
+
+			const bool textureChanged = !previous || previous->texture != batch.texture;
+			const bool blendChanged = !previous || previous->blendSrc != batch.blendSrc || previous->blendDst != batch.blendDst;
+
+			if(useGL)
+				submit(batch, textureChanged, blendChanged);
+
+			frameStats.stateChanges += (textureChanged ? 1 : 0) + (blendChanged ? 1 : 0);
+			frameStats.drawCalls++;
+		}
+
+		if(useGL)
+		{
+			glDisableClientState(GL_VERTEX_ARRAY);
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			glDisableClientState(GL_COLOR_ARRAY);
+
+			glDisable(GL_TEXTURE_2D);
+			glDisable(GL_BLEND);
+		}
+
+		batchCount = 0;
+	}
+
+	void endFrame()
+	{
+		flush();
+
+		lastFrameStats = frameStats;
+		frameStats = FrameStats();
+	}
+
+	const FrameStats& getFrameStats()
+	{
+		return lastFrameStats;
+	}
+
+	static size_t getBytesPerPixel(GLenum format)
+	{
+		return (format == GL_ALPHA) ? 1 : 4;
+	}
+
+	GLuint createTexture(unsigned int width, unsigned int height, GLenum format, bool linear, bool repeat, const void* data)
+	{
+		frameStats.texturesCreated++;
+		if(data != NULL)
+		{
+			frameStats.textureUploads++;
+			frameStats.uploadedBytes += width * height * getBytesPerPixel(format);
+		}
+
+		if(isHeadless())
+			return nextHeadlessTexture++;
+
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+
+		return texture;
+	}
+
+	void updateTexture(GLuint texture, int x, int y, unsigned int width, unsigned int height, GLenum format, const void* data)
+	{
+		frameStats.textureUploads++;
+		frameStats.uploadedBytes += width * height * getBytesPerPixel(format);
+
+		if(isHeadless())
+			return;
+
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, GL_UNSIGNED_BYTE, data);
+	}
+
+	void destroyTexture(GLuint texture)
+	{
+		flush();
+		frameStats.texturesDeleted++;
+
+		if(!isHeadless())
+			glDeleteTextures(1, &texture);
+	}
+};
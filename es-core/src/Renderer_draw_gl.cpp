@@ -80,8 +80,14 @@ namespace Renderer {
 		if(box.h < 0)
 			box.h = 0;
 
+		//whatever is queued was meant for the previous clip rect
+		flush();
+
 		clipStack.push(box);
 
+		if(isHeadless())
+			return;
+
 		glScissor(box.x, box.y, box.w, box.h);
 		glEnable(GL_SCISSOR_TEST);
 	}
@@ -94,7 +100,12 @@ namespace Renderer {
 			return;
 		}
 
+		flush();
+
 		clipStack.pop();
+		if(isHeadless())
+			return;
+
 		if(clipStack.empty())
 		{
 			glDisable(GL_SCISSOR_TEST);
@@ -111,44 +122,23 @@ namespace Renderer {
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor, GLenum blend_dfactor)
 	{
-#ifdef USE_OPENGL_ES
-		GLshort points[12];
-#else
-		GLint points[12];
-#endif
+		Vertex vertices[6];
+
+		vertices[0].pos = Vector2f((float)x, (float)y);
+		vertices[1].pos = Vector2f((float)x, (float)(y + h));
+		vertices[2].pos = Vector2f((float)(x + w), (float)y);
 
-		points[0] = x; points [1] = y;
-		points[2] = x; points[3] = y + h;
-		points[4] = x + w; points[5] = y;
+		vertices[3].pos = Vector2f((float)(x + w), (float)y);
+		vertices[4].pos = Vector2f((float)x, (float)(y + h));
+		vertices[5].pos = Vector2f((float)(x + w), (float)(y + h));
 
-		points[6] = x + w; points[7] = y;
-		points[8] = x; points[9] = y + h;
-		points[10] = x + w; points[11] = y + h;
+		for(int i = 0; i < 6; i++)
+			vertices[i].tex = Vector2f::Zero();
 
 		GLubyte colors[6*4];
 		buildGLColorArray(colors, color, 6);
 
-		glEnable(GL_BLEND);
-		glBlendFunc(blend_sfactor, blend_dfactor);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-#ifdef USE_OPENGL_ES
-		glVertexPointer(2, GL_SHORT, 0, points);
-#else
-		glVertexPointer(2, GL_INT, 0, points);
-#endif
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
-
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-
-		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
-	}
-
-	void setMatrix(const Transform4x4f& matrix)
-	{
-		glLoadMatrixf((GLfloat*)&matrix);
+		bindTexture(0);
+		drawTriangles(vertices, colors, 6, blend_sfactor, blend_dfactor);
 	}
 };
@@ -3,6 +3,7 @@
 #include "resources/ResourceManager.h"
 #include "ImageIO.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Settings.h"
 #include <SDL.h>
 
@@ -13,6 +14,7 @@
 namespace Renderer
 {
 	static bool initialCursorState;
+	static bool headless = false;
 
 	unsigned int windowWidth   = 0;
 	unsigned int windowHeight  = 0;
@@ -30,6 +32,8 @@ namespace Renderer
 	unsigned int getScreenOffsetY() { return screenOffsetY; }
 	unsigned int getScreenRotate()  { return screenRotate; }
 
+	bool isHeadless() { return headless; }
+
 	SDL_Window* sdlWindow = NULL;
 	SDL_GLContext sdlContext = NULL;
 
@@ -102,11 +106,9 @@ namespace Renderer
 		size_t width = 0;
 		size_t height = 0;
 		ResourceData resData = ResourceManager::getInstance()->getFileData(":/window_icon_256.png");
-		std::vector<unsigned char> rawData = ImageIO::loadFromMemoryRGBA32(resData.ptr.get(), resData.length, width, height);
+		std::vector<unsigned char> rawData = ImageIO::loadFromMemoryRGBA32(resData.ptr.get(), resData.length, width, height, true);
 		if (!rawData.empty())
 		{
-			ImageIO::flipPixelsVert(rawData.data(), width, height);
-
 			//SDL interprets each pixel as a 32-bit number, so our masks must depend on the endianness (byte order) of the machine
 			#if SDL_BYTEORDER == SDL_BIG_ENDIAN
 						Uint32 rmask = 0xff000000; Uint32 gmask = 0x00ff0000; Uint32 bmask = 0x0000ff00; Uint32 amask = 0x000000ff;
@@ -156,8 +158,28 @@ namespace Renderer
 		SDL_Quit();
 	}
 
+	//no window and no GL context, only the sizes everything is laid out for
+	bool initHeadless()
+	{
+		LOG(LogInfo) << "Starting headless renderer, draws and texture uploads are only counted";
+
+		windowWidth   = Settings::getInstance()->getInt("WindowWidth")   ? Settings::getInstance()->getInt("WindowWidth")   : 1280;
+		windowHeight  = Settings::getInstance()->getInt("WindowHeight")  ? Settings::getInstance()->getInt("WindowHeight")  : 720;
+		screenWidth   = Settings::getInstance()->getInt("ScreenWidth")   ? Settings::getInstance()->getInt("ScreenWidth")   : windowWidth;
+		screenHeight  = Settings::getInstance()->getInt("ScreenHeight")  ? Settings::getInstance()->getInt("ScreenHeight")  : windowHeight;
+		screenOffsetX = 0;
+		screenOffsetY = 0;
+		screenRotate  = 0;
+
+		return true;
+	}
+
 	bool init()
 	{
+		headless = Settings::getInstance()->getBool("Headless");
+		if(headless)
+			return initHeadless();
+
 		if(!createSurface())
 			return false;
 
@@ -206,16 +228,30 @@ namespace Renderer
 		glMatrixMode(GL_MODELVIEW);
 		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 
+		//rows of alpha textures like font glyphs aren't padded
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
 		return true;
 	}
 
 	void deinit()
 	{
+		if(headless)
+			return;
+
 		destroySurface();
 	}
 
 	void swapBuffers()
 	{
+		// with vsync, mostly the wait for the next refresh
+		PROFILE_SCOPE("Renderer::swapBuffers");
+
+		endFrame();
+		if(headless)
+			return;
+
 		SDL_GL_SwapWindow(sdlWindow);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	}
@@ -31,6 +31,7 @@ std::vector<const char*> settings_dont_save {
 	{ "ScreenOffsetX" },
 	{ "ScreenOffsetY" },
 	{ "ScreenRotate" },
+	{ "Headless" },
 	{ "ExePath" }
 };
 
@@ -55,14 +56,17 @@ void Settings::setDefaults()
 
 	mBoolMap["BackgroundJoystickInput"] = false;
 	mBoolMap["ParseGamelistOnly"] = false;
+	mBoolMap["GamelistCache"] = true;
 	mBoolMap["ShowHiddenFiles"] = false;
 	mBoolMap["DrawFramerate"] = false;
 	mBoolMap["ShowExit"] = true;
 	mBoolMap["Windowed"] = false;
+	mBoolMap["Headless"] = false;
 	mBoolMap["SplashScreen"] = true;
 	mStringMap["StartupSystem"] = "";
 
 	mBoolMap["VSync"] = true;
+	mBoolMap["SkipIdleFrames"] = true;
 
 	mBoolMap["EnableSounds"] = true;
 	mBoolMap["ShowHelpPrompts"] = true;
@@ -72,6 +76,8 @@ void Settings::setDefaults()
 	mBoolMap["QuickSystemSelect"] = true;
 	mBoolMap["MoveCarousel"] = true;
 	mBoolMap["SaveGamelistsOnExit"] = true;
+	mBoolMap["ParallelSystemLoad"] = true;
+	mIntMap["SystemLoadThreads"] = 0; // 0 = one per CPU core
 
 	mBoolMap["Debug"] = false;
 	mBoolMap["DebugGrid"] = false;
@@ -83,9 +89,13 @@ void Settings::setDefaults()
 	mIntMap["ScraperResizeHeight"] = 0;
 	#ifdef _RPI_
 		mIntMap["MaxVRAM"] = 80;
+		mIntMap["MaxTextureRAM"] = 80;
 	#else
 		mIntMap["MaxVRAM"] = 100;
+		mIntMap["MaxTextureRAM"] = 200;
 	#endif
+	mIntMap["TextureLoaderThreads"] = 0; // 0 = one per CPU core, minus the main thread
+	mIntMap["ThumbnailCacheSize"] = 200; // in MB, 0 = disabled
 
 	mStringMap["TransitionStyle"] = "fade";
 	mStringMap["ThemeSet"] = "";
@@ -4,15 +4,21 @@
 #include "components/ImageComponent.h"
 #include "resources/Font.h"
 #include "resources/TextureResource.h"
+#include "AsyncHandle.h"
 #include "InputManager.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include <algorithm>
 #include <iomanip>
 #include "Locale.h"
 
-Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10),
-	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mInfoPopup(NULL)
+// even a still screen is rendered this often, for whatever changes without telling
+#define MAX_STILL_TIME 1000
+
+Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mSkippedFrameCountElapsed(0), mAverageDeltaTime(10),
+	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mInfoPopup(NULL),
+	mFrameStill(false), mRenderRequested(true), mWasChanging(false), mLoadedTextures(0), mTimeSinceRender(0)
 {
 	mHelp = new HelpComponent(this);
 	mBackgroundOverlay = new ImageComponent(this);
@@ -38,6 +44,7 @@ void Window::pushGui(GuiComponent* gui)
 	}
 	mGuiStack.push_back(gui);
 	gui->updateHelpPrompts();
+	requestRender();
 }
 
 void Window::removeGui(GuiComponent* gui)
@@ -47,6 +54,7 @@ void Window::removeGui(GuiComponent* gui)
 		if(*i == gui)
 		{
 			i = mGuiStack.erase(i);
+			requestRender();
 
 			if(i == mGuiStack.cend() && mGuiStack.size()) // we just popped the stack and the stack is not empty
 			{
@@ -111,12 +119,16 @@ void Window::deinit()
 
 void Window::textInput(const char* text)
 {
+	requestRender();
+
 	if(peekGui())
 		peekGui()->textInput(text);
 }
 
 void Window::input(InputConfig* config, Input input)
 {
+	requestRender();
+
 	if (mScreenSaver) {
 		if(mScreenSaver->isScreenSaverActive() && Settings::getInstance()->getBool("ScreenSaverControls") &&
 		   (Settings::getInstance()->getString("ScreenSaverBehavior") == "random video"))
@@ -186,6 +198,8 @@ void Window::input(InputConfig* config, Input input)
 
 void Window::update(int deltaTime)
 {
+	PROFILE_SCOPE("Window::update");
+
 	if(mNormalizeNextUpdate)
 	{
 		mNormalizeNextUpdate = false;
@@ -201,24 +215,50 @@ void Window::update(int deltaTime)
 
 		if(Settings::getInstance()->getBool("DrawFramerate"))
 		{
+			if(!Profiler::isRunning())
+				Profiler::start(false);
+
 			std::stringstream ss;
 
 			// fps
 			ss << std::fixed << std::setprecision(1) << (1000.0f * (float)mFrameCountElapsed / (float)mFrameTimeElapsed) << "fps, ";
-			ss << std::fixed << std::setprecision(2) << ((float)mFrameTimeElapsed / (float)mFrameCountElapsed) << "ms";
+			ss << std::fixed << std::setprecision(2) << ((float)mFrameTimeElapsed / (float)mFrameCountElapsed) << "ms, ";
+			ss << std::setprecision(0) << (100.0f * (float)mSkippedFrameCountElapsed / (float)mFrameCountElapsed) << "% skipped" << std::setprecision(2);
+
+			// frame time percentiles since the overlay was turned on, of the frames that were rendered
+			ss << "\nFrame: p50 " << Profiler::getFrameTime(0.5f) << " p95 " << Profiler::getFrameTime(0.95f) <<
+				  " p99 " << Profiler::getFrameTime(0.99f) << " ms";
 
 			// vram
-			float textureVramUsageMb = TextureResource::getTotalMemUsage() / 1000.0f / 1000.0f;
+			float textureVramUsageMb = TextureResource::getTotalVRAMUsage() / 1000.0f / 1000.0f;
+			float textureRamUsageMb = TextureResource::getTotalRAMUsage() / 1000.0f / 1000.0f;
 			float textureTotalUsageMb = TextureResource::getTotalTextureSize() / 1000.0f / 1000.0f;
 			float fontVramUsageMb = Font::getTotalMemUsage() / 1000.0f / 1000.0f;
 
 			ss << "\nFont VRAM: " << fontVramUsageMb << " Tex VRAM: " << textureVramUsageMb <<
-				  " Tex Max: " << textureTotalUsageMb;
+				  " Tex RAM: " << textureRamUsageMb << " Tex Max: " << textureTotalUsageMb <<
+				  " Atlas: " << TextureAtlas::getPageCount() << " pages";
+
+			// texture cache tiers
+			ss << std::setprecision(0) << "\nTex Hits: " << (TextureResource::getVRAMHitRate() * 100.0f) << "% VRAM, " <<
+				  (TextureResource::getRAMHitRate() * 100.0f) << "% RAM" << std::setprecision(2);
+
+			// draws and how many GL calls they took, the batching merges those that share a texture and blending
+			const Renderer::FrameStats& frameStats = Renderer::getFrameStats();
+			ss << "\nDraws: " << frameStats.draws << " queued, " << frameStats.drawCalls << " GL calls, " <<
+				  frameStats.stateChanges << " state changes";
+
+			// texture loader queues
+			ss << "\nTex Queue: " << TextureResource::getQueueDepth(TextureLoader::LANE_VISIBLE) << " visible, " <<
+				  TextureResource::getQueueDepth(TextureLoader::LANE_PREFETCH) << " prefetch, " <<
+				  TextureResource::getQueueDepth(TextureLoader::LANE_BACKGROUND) << " background";
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(1)->buildTextCache(ss.str(), 50.f, 50.f, 0xFF00FFFF));
+			requestRender();
 		}
 
 		mFrameTimeElapsed = 0;
 		mFrameCountElapsed = 0;
+		mSkippedFrameCountElapsed = 0;
 	}
 
 	mTimeSinceLastInput += deltaTime;
@@ -229,10 +269,32 @@ void Window::update(int deltaTime)
 	// Update the screensaver
 	if (mScreenSaver)
 		mScreenSaver->update(deltaTime);
+
+	// skip the frame if it would come out the same as the last one
+	const bool changing = isChanging();
+	const unsigned int loadedTextures = TextureResource::getLoadedCount();
+	const unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
+	mTimeSinceRender += deltaTime;
+
+	mFrameStill = Settings::getInstance()->getBool("SkipIdleFrames") && !mRenderRequested && !changing && !mWasChanging &&
+		(loadedTextures == mLoadedTextures) && (AsyncHandle::aliveHandles() == 0) && !mRenderScreenSaver &&
+		!(mInfoPopup && mInfoPopup->isRunning()) && !(screensaverTime != 0 && mTimeSinceLastInput >= screensaverTime) &&
+		(mTimeSinceRender < MAX_STILL_TIME);
+
+	mRenderRequested = false;
+	mWasChanging = changing;
+	mLoadedTextures = loadedTextures;
+
+	if(mFrameStill)
+		mSkippedFrameCountElapsed++;
+	else
+		mTimeSinceRender = 0;
 }
 
 void Window::render()
 {
+	PROFILE_SCOPE("Window::render");
+
 	Transform4x4f transform = Transform4x4f::Identity();
 
 	mRenderedHelpPrompts = false;
@@ -287,6 +349,7 @@ void Window::render()
 void Window::normalizeNextUpdate()
 {
 	mNormalizeNextUpdate = true;
+	requestRender();
 }
 
 bool Window::getAllowSleep()
@@ -299,8 +362,11 @@ void Window::setAllowSleep(bool sleep)
 	mAllowSleep = sleep;
 }
 
-void Window::renderLoadingScreen()
+void Window::renderLoadingScreen(std::string text, float percent)
 {
+	if(text.empty())
+		text = _("LOADING...");
+
 	Transform4x4f trans = Transform4x4f::Identity();
 	Renderer::setMatrix(trans);
 	Renderer::drawRect(0, 0, Renderer::getScreenWidth(), Renderer::getScreenHeight(), 0x000000FF);
@@ -311,8 +377,20 @@ void Window::renderLoadingScreen()
 	splash.setPosition((Renderer::getScreenWidth() - splash.getSize().x()) / 2, (Renderer::getScreenHeight() - splash.getSize().y()) / 2 * 0.6f);
 	splash.render(trans);
 
+	if(percent >= 0.0f)
+	{
+		const float barWidth = Renderer::getScreenWidth() * 0.25f;
+		const float barHeight = Renderer::getScreenHeight() * 0.0075f;
+		const float barX = (Renderer::getScreenWidth() - barWidth) / 2.0f;
+		const float barY = Renderer::getScreenHeight() * 0.8f;
+
+		Renderer::setMatrix(Transform4x4f::Identity());
+		Renderer::drawRect(barX, barY, barWidth, barHeight, 0x222222FF);
+		Renderer::drawRect(barX, barY, barWidth * Math::clamp(percent, 0.0f, 1.0f), barHeight, 0x656565FF);
+	}
+
 	auto& font = mDefaultFonts.at(1);
-	TextCache* cache = font->buildTextCache(_("LOADING..."), 0, 0, 0x656565FF);
+	TextCache* cache = font->buildTextCache(text, 0, 0, 0x656565FF);
 	trans = trans.translate(Vector3f(Math::round((Renderer::getScreenWidth() - cache->metrics.size.x()) / 2.0f),
 		Math::round(Renderer::getScreenHeight() * 0.835f), 0.0f));
 	Renderer::setMatrix(trans);
@@ -395,6 +473,7 @@ void Window::setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpSt
 	});
 
 	mHelp->setPrompts(addPrompts);
+	requestRender();
 }
 
 
@@ -412,6 +491,41 @@ bool Window::isProcessing()
 	return count_if(mGuiStack.cbegin(), mGuiStack.cend(), [](GuiComponent* c) { return c->isProcessing(); }) > 0;
 }
 
+int Window::getTimeUntilChange()
+{
+	int time = MAX_STILL_TIME - mTimeSinceRender;
+
+	const unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
+	if(screensaverTime != 0 && mTimeSinceLastInput < screensaverTime)
+		time = std::min(time, (int)(screensaverTime - mTimeSinceLastInput));
+
+	// the frame rate overlay is updated every 500ms
+	if(Settings::getInstance()->getBool("DrawFramerate"))
+		time = std::min(time, 500 - mFrameTimeElapsed + 1);
+
+	// only the bottom and the top of the stack are drawn
+	if(!mGuiStack.empty())
+	{
+		const int bottomTime = mGuiStack.front()->getTimeUntilChange();
+		const int topTime = mGuiStack.back()->getTimeUntilChange();
+		if(bottomTime >= 0)
+			time = std::min(time, bottomTime);
+		if(topTime >= 0)
+			time = std::min(time, topTime);
+	}
+
+	return std::max(time, 0);
+}
+
+bool Window::isChanging()
+{
+	// only the bottom and the top of the stack are drawn
+	if(mGuiStack.empty())
+		return false;
+
+	return mGuiStack.front()->isChanging() || mGuiStack.back()->isChanging() || isProcessing();
+}
+
 void Window::startScreenSaver()
  {
  	if (mScreenSaver && !mRenderScreenSaver)
@@ -431,6 +545,7 @@ void Window::startScreenSaver()
  	{
  		mScreenSaver->stopScreenSaver();
  		mRenderScreenSaver = false;
+ 		requestRender();
 
  		// Tell the GUI components the screensaver has stopped
  		for(auto i = mGuiStack.cbegin(); i != mGuiStack.cend(); i++)
@@ -38,6 +38,7 @@ public:
 	public:
 		virtual void render(const Transform4x4f& parentTrans) = 0;
 		virtual void stop() = 0;
+		virtual bool isRunning() = 0;
 		virtual ~InfoPopup() {};
 	};
 
@@ -59,11 +60,20 @@ public:
 
 	void normalizeNextUpdate();
 
+	// False once update() found nothing on screen could have changed since the last rendered frame,
+	// render() and the buffer swap are skipped then. Anything that changes the screen on its own should requestRender().
+	inline bool isFrameStill() const { return mFrameStill; }
+	inline void requestRender() { mRenderRequested = true; }
+
+	// While the frame is still: milliseconds until update() has something to do without input (the screensaver
+	// kicking in, a forced render, a component starting to change...), so the main loop can wait for input that long.
+	int getTimeUntilChange();
+
 	inline bool isSleeping() const { return mSleeping; }
 	bool getAllowSleep();
 	void setAllowSleep(bool sleep);
 
-	void renderLoadingScreen();
+	void renderLoadingScreen(std::string text = "", float percent = -1.0f); // percent in [0, 1] draws a progress bar, negative hides it
 
 	void renderHelpPromptsEarly(); // used to render HelpPrompts before a fade
 	void setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpStyle& style);
@@ -82,6 +92,9 @@ private:
 
 	// Returns true if at least one component on the stack is processing
 	bool isProcessing();
+
+	// Returns true if what is drawn of the stack changes without input
+	bool isChanging();
 	
 	HelpComponent* mHelp;
 	ImageComponent* mBackgroundOverlay;
@@ -95,6 +108,7 @@ private:
 
 	int mFrameTimeElapsed;
 	int mFrameCountElapsed;
+	int mSkippedFrameCountElapsed;
 	int mAverageDeltaTime;
 
 	std::unique_ptr<TextCache> mFrameDataText;
@@ -106,6 +120,12 @@ private:
 	unsigned int mTimeSinceLastInput;
 
 	bool mRenderedHelpPrompts;
+
+	bool mFrameStill;
+	bool mRenderRequested;
+	bool mWasChanging; // the frame after a change stops has to show where it stopped
+	unsigned int mLoadedTextures;
+	int mTimeSinceRender;
 };
 
 #endif // ES_CORE_WINDOW_H
@@ -79,6 +79,11 @@ void AnimatedImageComponent::update(int deltaTime)
 	}
 }
 
+bool AnimatedImageComponent::isChanging() const
+{
+	return GuiComponent::isChanging() || (mEnabled && (mFrames.size() > 1));
+}
+
 void AnimatedImageComponent::render(const Transform4x4f& trans)
 {
 	if(mFrames.size())
@@ -195,7 +195,7 @@ void ComponentGrid::updateSeparators()
 		}
 	}
 
-	mLineColors.reserve(mLines.size());
+	mLineColors.resize(mLines.size());
 	Renderer::buildGLColorArray((GLubyte*)mLineColors.data(), 0xC6C7C6FF, (unsigned int)mLines.size());
 }
 
@@ -367,19 +367,14 @@ void ComponentGrid::render(const Transform4x4f& parentTrans)
 	{
 		Renderer::setMatrix(trans);
 
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, 0, &mLines[0].x);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, mLineColors.data());
-
-		glDrawArrays(GL_LINES, 0, (GLsizei)mLines.size());
+		std::vector<Renderer::Vertex> vertices(mLines.size());
+		for(size_t i = 0; i < mLines.size(); i++)
+		{
+			vertices[i].pos = Vector2f(mLines[i].x, mLines[i].y);
+			vertices[i].tex = Vector2f::Zero();
+		}
 
-		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		Renderer::drawLines(vertices.data(), (const GLubyte*)mLineColors.data(), (unsigned int)vertices.size());
 	}
 }
 
@@ -1,5 +1,6 @@
 #include "GridTileComponent.h"
 
+#include "math/Misc.h"
 #include "resources/TextureResource.h"
 #include "ThemeData.h"
 #include "Renderer.h"
@@ -150,6 +151,11 @@ bool GridTileComponent::isSelected() const
 
 void GridTileComponent::setImage(const std::string& path)
 {
+	// the image is drawn at most at the selected tile size
+	const Vector2f defaultSize = mDefaultProperties.mSize - mDefaultProperties.mPadding * 2;
+	const Vector2f selectedSize = mSelectedProperties.mSize - mSelectedProperties.mPadding * 2;
+	mImage->setTextureMaxSize(Vector2f(Math::max(defaultSize.x(), selectedSize.x()), Math::max(defaultSize.y(), selectedSize.y())));
+
 	mImage->setImage(path);
 
 	// Resize now to prevent flickering images when scrolling
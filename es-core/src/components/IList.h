@@ -103,6 +103,12 @@ public:
 		return mScrollVelocity;
 	}
 
+	bool isChanging() const override
+	{
+		// held down to scroll, or the title overlay hasn't faded out yet
+		return GuiComponent::isChanging() || mScrollVelocity != 0 || mTitleOverlayOpacity != 0;
+	}
+
 	void stopScrolling()
 	{
 		listInput(0);
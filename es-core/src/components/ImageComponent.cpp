@@ -21,7 +21,7 @@ Vector2f ImageComponent::getSize() const
 }
 
 ImageComponent::ImageComponent(Window* window, bool forceLoad, bool dynamic) : GuiComponent(window),
-	mTargetIsMax(false), mTargetIsMin(false), mFlipX(false), mFlipY(false), mTargetSize(0, 0), mColorShift(0xFFFFFFFF),
+	mTargetIsMax(false), mTargetIsMin(false), mFlipX(false), mFlipY(false), mTargetSize(0, 0), mTextureMaxSize(0, 0), mColorShift(0xFFFFFFFF),
 	mForceLoad(forceLoad), mDynamic(dynamic), mFadeOpacity(0), mFading(false), mRotateByTargetSize(false),
 	mTopLeftCrop(0.0f, 0.0f), mBottomRightCrop(1.0f, 1.0f)
 {
@@ -139,9 +139,9 @@ void ImageComponent::setImage(std::string path, bool tile)
 		if(mDefaultPath.empty() || !ResourceManager::getInstance()->fileExists(mDefaultPath))
 			mTexture.reset();
 		else
-			mTexture = TextureResource::get(mDefaultPath, tile, mForceLoad, mDynamic);
+			mTexture = TextureResource::get(mDefaultPath, tile, mForceLoad, mDynamic, getTextureMaxSize());
 	} else {
-		mTexture = TextureResource::get(path, tile, mForceLoad, mDynamic);
+		mTexture = TextureResource::get(path, tile, mForceLoad, mDynamic, getTextureMaxSize());
 	}
 
 	resize();
@@ -187,6 +187,20 @@ void ImageComponent::setMinSize(float width, float height)
 	resize();
 }
 
+void ImageComponent::setTextureMaxSize(const Vector2f& size)
+{
+	mTextureMaxSize = size;
+}
+
+Vector2f ImageComponent::getTextureMaxSize() const
+{
+	if(mTextureMaxSize != Vector2f::Zero())
+		return mTextureMaxSize;
+
+	// a max size is the only one that can't end up larger than the target size
+	return mTargetIsMax ? mTargetSize : Vector2f::Zero();
+}
+
 Vector2f ImageComponent::getRotationSize() const
 {
 	return mRotateByTargetSize ? mTargetSize : mSize;
@@ -336,26 +350,20 @@ void ImageComponent::render(const Transform4x4f& parentTrans)
 			// when it finally loads
 			fadeIn(mTexture->bind());
 
-			glEnable(GL_TEXTURE_2D);
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-			glEnableClientState(GL_COLOR_ARRAY);
-
-			glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-			glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-			glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-			glDisableClientState(GL_COLOR_ARRAY);
+			// packed into an atlas page, draw its rectangle of it
+			const Renderer::Vertex* vertices = mVertices;
+			Renderer::Vertex atlasVertices[6];
+			if(mTexture->isInAtlas())
+			{
+				for(int i = 0; i < 6; i++)
+				{
+					atlasVertices[i].pos = mVertices[i].pos;
+					atlasVertices[i].tex = mTexture->mapTexCoord(mVertices[i].tex);
+				}
+				vertices = atlasVertices;
+			}
 
-			glDisable(GL_TEXTURE_2D);
-			glDisable(GL_BLEND);
+			Renderer::drawTriangles(vertices, mColors, 6);
 		}else{
 			LOG(LogError) << "Image texture is not initialized!";
 			mTexture.reset();
@@ -365,6 +373,12 @@ void ImageComponent::render(const Transform4x4f& parentTrans)
 	GuiComponent::renderChildren(trans);
 }
 
+bool ImageComponent::isChanging() const
+{
+	// the fade only moves on once the texture is loaded, until then it's up to the loader to tell a new frame is needed
+	return GuiComponent::isChanging() || (mFading && (mFadeOpacity != 0));
+}
+
 void ImageComponent::fadeIn(bool textureLoaded)
 {
 	if (!mForceLoad)
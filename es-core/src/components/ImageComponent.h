@@ -4,8 +4,7 @@
 
 #include "math/Vector2i.h"
 #include "GuiComponent.h"
-#include "platform.h"
-#include GLHEADER
+#include "Renderer.h"
 
 class TextureResource;
 
@@ -43,6 +42,10 @@ public:
 	void setMinSize(float width, float height);
 	inline void setMinSize(const Vector2f& size) { setMinSize(size.x(), size.y()); }
 
+	// The largest size images set from now on will be drawn at, so bitmaps can be shrunk to it when they are loaded.
+	// Defaults to the max size, if one is set. Zero loads them at full resolution.
+	void setTextureMaxSize(const Vector2f& size);
+
 	Vector2f getRotationSize() const override;
 
 	// Applied AFTER image positioning and sizing
@@ -70,6 +73,7 @@ public:
 	bool hasImage();
 
 	void render(const Transform4x4f& parentTrans) override;
+	bool isChanging() const override;
 
 	virtual void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
@@ -79,15 +83,14 @@ private:
 
 	bool mFlipX, mFlipY, mTargetIsMax, mTargetIsMin;
 
+	Vector2f mTextureMaxSize;
+	Vector2f getTextureMaxSize() const;
+
 	// Calculates the correct mSize from our resizing information (set by setResize/setMaxSize).
 	// Used internally whenever the resizing parameters or texture change.
 	void resize();
 
-	struct Vertex
-	{
-		Vector2f pos;
-		Vector2f tex;
-	} mVertices[6];
+	Renderer::Vertex mVertices[6];
 
 	GLubyte mColors[6*4];
 
@@ -48,7 +48,7 @@ void NinePatchComponent::buildVertices()
 		return;
 	}
 
-	mVertices = new Vertex[6 * 9];
+	mVertices = new Renderer::Vertex[6 * 9];
 	mColors = new GLubyte[6 * 9 * 4];
 	updateColors();
 
@@ -112,26 +112,20 @@ void NinePatchComponent::render(const Transform4x4f& parentTrans)
 
 		mTexture->bind();
 
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-		glDrawArrays(GL_TRIANGLES, 0, 6 * 9);
-
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
-
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
+		// packed into an atlas page, draw its rectangle of it
+		const Renderer::Vertex* vertices = mVertices;
+		Renderer::Vertex atlasVertices[6 * 9];
+		if(mTexture->isInAtlas())
+		{
+			for(int i = 0; i < 6 * 9; i++)
+			{
+				atlasVertices[i].pos = mVertices[i].pos;
+				atlasVertices[i].tex = mTexture->mapTexCoord(mVertices[i].tex);
+			}
+			vertices = atlasVertices;
+		}
+
+		Renderer::drawTriangles(vertices, mColors, 6 * 9);
 	}
 
 	renderChildren(trans);
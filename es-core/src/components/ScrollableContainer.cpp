@@ -103,8 +103,14 @@ void ScrollableContainer::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool ScrollableContainer::isChanging() const
+{
+	// content that fits doesn't move, even with autoscroll on
+	return GuiComponent::isChanging() || ((mAutoScrollSpeed != 0) && (getContentSize().y() > getSize().y()));
+}
+
 //this should probably return a box to allow for when controls don't start at 0,0
-Vector2f ScrollableContainer::getContentSize()
+Vector2f ScrollableContainer::getContentSize() const
 {
 	Vector2f max(0, 0);
 	for(unsigned int i = 0; i < mChildren.size(); i++)
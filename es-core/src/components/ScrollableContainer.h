@@ -16,9 +16,10 @@ public:
 
 	void update(int deltaTime) override;
 	void render(const Transform4x4f& parentTrans) override;
+	bool isChanging() const override;
 
 private:
-	Vector2f getContentSize();
+	Vector2f getContentSize() const;
 
 	Vector2f mScrollPos;
 	Vector2f mScrollDir;
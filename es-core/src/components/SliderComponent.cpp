@@ -60,6 +60,11 @@ void SliderComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool SliderComponent::isChanging() const
+{
+	return GuiComponent::isChanging() || (mMoveRate != 0);
+}
+
 void SliderComponent::render(const Transform4x4f& parentTrans)
 {
 	Transform4x4f trans = parentTrans * getTransform();
@@ -21,6 +21,7 @@ public:
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
 	void render(const Transform4x4f& parentTrans) override;
+	bool isChanging() const override;
 	
 	void onSizeChanged() override;
 	
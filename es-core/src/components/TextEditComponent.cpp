@@ -177,6 +177,11 @@ void TextEditComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool TextEditComponent::isChanging() const
+{
+	return GuiComponent::isChanging() || (mCursorRepeatDir != 0);
+}
+
 void TextEditComponent::updateCursorRepeat(int deltaTime)
 {
 	if(mCursorRepeatDir == 0)
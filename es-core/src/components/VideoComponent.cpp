@@ -309,6 +309,12 @@ void VideoComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool VideoComponent::isChanging() const
+{
+	// new frames keep coming while it plays, and there is a fade before it starts
+	return GuiComponent::isChanging() || mIsPlaying || mStartDelayed || (mFadeIn < 1.0f);
+}
+
 void VideoComponent::manageState()
 {
 	// We will only show if the component is on display and the screensaver
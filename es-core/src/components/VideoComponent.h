@@ -56,6 +56,7 @@ public:
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 
 	virtual void update(int deltaTime);
+	bool isChanging() const override;
 
 	// Resize the video to fit this size. If one axis is zero, scale that axis to maintain aspect ratio.
 	// If both are non-zero, potentially break the aspect ratio.  If both are zero, no resizing.
@@ -151,13 +151,7 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 		x2 = mSize.x();
 		y2 = mSize.y();
 
-		// Define a structure to contain the data for each vertex
-		struct Vertex
-		{
-			Vector2f pos;
-			Vector2f tex;
-			Vector4f colour;
-		} vertices[6];
+		Renderer::Vertex vertices[6];
 
 		// We need two triangles to cover the rectangular area
 		vertices[0].pos[0] = x; 			vertices[0].pos[1] = y;
@@ -178,35 +172,16 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 		vertices[5].tex[0] = 1.0f + tex_offs_x;		vertices[5].tex[1] = 1.0f + tex_offs_y;
 
 		// Colours - use this to fade the video in and out
-		for (int i = 0; i < (4 * 6); ++i) {
-			if ((i%4) < 3)
-				vertices[i / 4].colour[i % 4] = mFadeIn;
-			else
-				vertices[i / 4].colour[i % 4] = 1.0f;
-		}
-
-		glEnable(GL_TEXTURE_2D);
+		const unsigned int fade = (unsigned int)Math::round(Math::clamp(mFadeIn, 0.0f, 1.0f) * 255.0f);
+		GLubyte colors[6 * 4];
+		Renderer::buildGLColorArray(colors, (fade << 24) | (fade << 16) | (fade << 8) | 0xFF, 6);
 
 		// Build a texture for the video frame
 		mTexture->initFromPixels((unsigned char*)mContext.surface->pixels, mContext.surface->w, mContext.surface->h);
 		mTexture->bind();
 
-		// Render it
-		glEnableClientState(GL_COLOR_ARRAY);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-
-		glColorPointer(4, GL_FLOAT, sizeof(Vertex), &vertices[0].colour);
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].tex);
-
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
-
-		glDisable(GL_TEXTURE_2D);
+		// Render it, the frame is opaque so there is nothing to blend
+		Renderer::drawTriangles(vertices, colors, 6, GL_ONE, GL_ZERO);
 	} else {
 		VideoComponent::renderSnapshot(parentTrans);
 	}
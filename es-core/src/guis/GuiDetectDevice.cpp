@@ -126,3 +126,9 @@ void GuiDetectDevice::update(int deltaTime)
 		}
 	}
 }
+
+bool GuiDetectDevice::isChanging() const
+{
+	// the held device's name fades while it counts down
+	return GuiComponent::isChanging() || (mHoldingConfig != NULL);
+}
@@ -15,6 +15,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isChanging() const override;
 	void onSizeChanged() override;
 
 private:
@@ -262,6 +262,11 @@ void GuiInputConfig::update(int deltaTime)
 	}
 }
 
+bool GuiInputConfig::isChanging() const
+{
+	return GuiComponent::isChanging() || mHoldingInput;
+}
+
 // move cursor to the next thing if we're configuring all, 
 // or come out of "configure mode" if we were only configuring one row
 void GuiInputConfig::rowDone()
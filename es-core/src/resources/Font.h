@@ -141,11 +141,7 @@ private:
 class TextCache
 {
 protected:
-	struct Vertex
-	{
-		Vector2f pos;
-		Vector2f tex;
-	};
+	typedef Renderer::Vertex Vertex;
 
 	struct VertexList
 	{
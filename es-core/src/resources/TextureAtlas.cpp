@@ -0,0 +1,288 @@
+#include "resources/TextureAtlas.h"
+
+#include "Renderer.h"
+#include <algorithm>
+#include <string.h>
+
+// every entry gets a border of its own edge pixels, so linear filtering never picks up a neighbour
+#define PADDING 1
+
+std::vector<std::shared_ptr<TextureAtlas::Page> > TextureAtlas::sPages;
+
+// Packs entries shelf by shelf: rows of entries of about the same height, stacked from the bottom of the page up
+class TextureAtlas::Page
+{
+public:
+	Page() : mDataRGBA(PAGE_SIZE * PAGE_SIZE * 4, 0), mNextShelfY(0), mTextureID(0), mDirtyMinY(0), mDirtyMaxY(0), mEntries(0)
+	{
+	}
+
+	~Page()
+	{
+		if (mTextureID != 0)
+			Renderer::destroyTexture(mTextureID);
+	}
+
+	// Finds room for a width x height rectangle, returns false if there is none left
+	bool allocate(int width, int height, int& x, int& y)
+	{
+		// room freed by entries that are gone first, on the lowest shelf it fits, so tall shelves aren't wasted on small entries
+		Shelf* bestShelf = nullptr;
+		std::vector<Span>::iterator bestSpan;
+		for (auto it = mShelves.begin(); it != mShelves.end(); ++it)
+		{
+			if ((height > it->height) || (bestShelf && (it->height >= bestShelf->height)))
+				continue;
+
+			for (auto spanIt = it->freeSpans.begin(); spanIt != it->freeSpans.end(); ++spanIt)
+			{
+				if (width <= spanIt->width)
+				{
+					bestShelf = &(*it);
+					bestSpan = spanIt;
+					break;
+				}
+			}
+		}
+
+		if (bestShelf)
+		{
+			x = bestSpan->x;
+			y = bestShelf->y;
+			bestSpan->x += width;
+			bestSpan->width -= width;
+			if (bestSpan->width == 0)
+				bestShelf->freeSpans.erase(bestSpan);
+			return true;
+		}
+
+		// then the lowest shelf that still has room at its end
+		Shelf* best = nullptr;
+		for (auto it = mShelves.begin(); it != mShelves.end(); ++it)
+		{
+			if ((height <= it->height) && ((it->x + width) <= PAGE_SIZE) && (!best || (it->height < best->height)))
+				best = &(*it);
+		}
+
+		if (!best)
+		{
+			if (((mNextShelfY + height) > PAGE_SIZE) || (width > PAGE_SIZE))
+				return false;
+
+			Shelf shelf;
+			shelf.y = mNextShelfY;
+			shelf.height = height;
+			shelf.x = 0;
+			mShelves.push_back(shelf);
+			mNextShelfY += height;
+			best = &mShelves.back();
+		}
+
+		x = best->x;
+		y = best->y;
+		best->x += width;
+		return true;
+	}
+
+	// Makes the room of a rectangle allocate() returned available again
+	void deallocate(int x, int y, int width)
+	{
+		auto shelf = mShelves.begin();
+		while ((shelf != mShelves.end()) && (shelf->y != y))
+			++shelf;
+		if (shelf == mShelves.end())
+			return;
+
+		// merged with the free spans right next to it, the spans are kept sorted by x
+		Span span = { x, width };
+		auto it = shelf->freeSpans.begin();
+		while ((it != shelf->freeSpans.end()) && (it->x < span.x))
+			++it;
+		if ((it != shelf->freeSpans.end()) && ((span.x + span.width) == it->x))
+		{
+			span.width += it->width;
+			it = shelf->freeSpans.erase(it);
+		}
+		if ((it != shelf->freeSpans.begin()) && (((it - 1)->x + (it - 1)->width) == span.x))
+		{
+			--it;
+			span.x = it->x;
+			span.width += it->width;
+			it = shelf->freeSpans.erase(it);
+		}
+
+		// at the end of the shelf it just gives the room back to it
+		if ((span.x + span.width) == shelf->x)
+			shelf->x = span.x;
+		else
+			shelf->freeSpans.insert(it, span);
+
+		// and empty shelves at the top give their height back to the page
+		while (!mShelves.empty() && (mShelves.back().x == 0))
+		{
+			mNextShelfY -= mShelves.back().height;
+			mShelves.pop_back();
+		}
+	}
+
+	// Copies the pixels to x, y and repeats their edges into the padding around them
+	void write(const unsigned char* dataRGBA, int width, int height, int x, int y)
+	{
+		const size_t rowSize = PAGE_SIZE * 4;
+
+		for (int row = 0; row < height; ++row)
+		{
+			unsigned char* dst = &mDataRGBA[((y + PADDING + row) * rowSize) + (x * 4)];
+			const unsigned char* src = dataRGBA + (row * width * 4);
+
+			memcpy(dst + (PADDING * 4), src, width * 4);
+			for (int i = 0; i < PADDING; ++i)
+			{
+				memcpy(dst + (i * 4), src, 4);
+				memcpy(dst + ((PADDING + width + i) * 4), src + ((width - 1) * 4), 4);
+			}
+		}
+
+		const size_t paddedRowSize = (width + (PADDING * 2)) * 4;
+		for (int i = 0; i < PADDING; ++i)
+		{
+			memcpy(&mDataRGBA[((y + i) * rowSize) + (x * 4)], &mDataRGBA[((y + PADDING) * rowSize) + (x * 4)], paddedRowSize);
+			memcpy(&mDataRGBA[((y + PADDING + height + i) * rowSize) + (x * 4)], &mDataRGBA[((y + PADDING + height - 1) * rowSize) + (x * 4)], paddedRowSize);
+		}
+
+		// uploaded with the next bind
+		const int bottom = y;
+		const int top = y + height + (PADDING * 2);
+		if (mDirtyMinY >= mDirtyMaxY)
+		{
+			mDirtyMinY = bottom;
+			mDirtyMaxY = top;
+		}
+		else
+		{
+			mDirtyMinY = std::min(mDirtyMinY, bottom);
+			mDirtyMaxY = std::max(mDirtyMaxY, top);
+		}
+	}
+
+	bool bind()
+	{
+		if (mTextureID == 0)
+		{
+			mTextureID = Renderer::createTexture(PAGE_SIZE, PAGE_SIZE, GL_RGBA, true, false, mDataRGBA.data());
+			mDirtyMinY = mDirtyMaxY = 0;
+			Renderer::bindTexture(mTextureID);
+			return true;
+		}
+
+		// only the rows that changed since the last bind
+		if (mDirtyMinY < mDirtyMaxY)
+		{
+			Renderer::updateTexture(mTextureID, 0, mDirtyMinY, PAGE_SIZE, mDirtyMaxY - mDirtyMinY, GL_RGBA, &mDataRGBA[mDirtyMinY * PAGE_SIZE * 4]);
+			mDirtyMinY = mDirtyMaxY = 0;
+		}
+
+		Renderer::bindTexture(mTextureID);
+		return true;
+	}
+
+	struct Span
+	{
+		int x;
+		int width;
+	};
+
+	struct Shelf
+	{
+		int y;
+		int height;
+		int x; // where the room at its end starts
+		std::vector<Span> freeSpans; // room of entries that are gone, before x
+	};
+
+	std::vector<unsigned char>	mDataRGBA;
+	std::vector<Shelf>			mShelves;
+	int							mNextShelfY;
+	GLuint						mTextureID;
+	int							mDirtyMinY;
+	int							mDirtyMaxY;
+	int							mEntries;
+};
+
+TextureAtlas::Entry::Entry(const std::shared_ptr<Page>& page, int x, int y, int width, int height) : mPage(page), mX(x), mY(y), mWidth(width + (PADDING * 2))
+{
+	mPage->mEntries++;
+	mTexCoordOffset = Vector2f((float)(x + PADDING) / PAGE_SIZE, (float)(y + PADDING) / PAGE_SIZE);
+	mTexCoordScale = Vector2f((float)width / PAGE_SIZE, (float)height / PAGE_SIZE);
+}
+
+TextureAtlas::Entry::~Entry()
+{
+	mPage->deallocate(mX, mY, mWidth);
+	mPage->mEntries--;
+	TextureAtlas::release(mPage.get());
+}
+
+bool TextureAtlas::Entry::bind()
+{
+	return mPage->bind();
+}
+
+Vector2f TextureAtlas::Entry::mapTexCoord(const Vector2f& texCoord) const
+{
+	return mTexCoordOffset + (texCoord * mTexCoordScale);
+}
+
+std::shared_ptr<TextureAtlas::Entry> TextureAtlas::add(const unsigned char* dataRGBA, size_t width, size_t height)
+{
+	if ((dataRGBA == nullptr) || (width == 0) || (height == 0) || (width > MAX_ENTRY_SIZE) || (height > MAX_ENTRY_SIZE))
+		return nullptr;
+
+	const int paddedWidth = (int)width + (PADDING * 2);
+	const int paddedHeight = (int)height + (PADDING * 2);
+	int x, y;
+
+	std::shared_ptr<Page> page;
+	for (auto it = sPages.cbegin(); it != sPages.cend(); ++it)
+	{
+		if ((*it)->allocate(paddedWidth, paddedHeight, x, y))
+		{
+			page = *it;
+			break;
+		}
+	}
+
+	if (!page)
+	{
+		if (sPages.size() >= MAX_PAGES)
+			return nullptr;
+
+		page = std::make_shared<Page>();
+		if (!page->allocate(paddedWidth, paddedHeight, x, y))
+			return nullptr;
+		sPages.push_back(page);
+	}
+
+	page->write(dataRGBA, (int)width, (int)height, x, y);
+	return std::make_shared<Entry>(page, x, y, (int)width, (int)height);
+}
+
+size_t TextureAtlas::getPageCount()
+{
+	return sPages.size();
+}
+
+void TextureAtlas::release(Page* page)
+{
+	if (page->mEntries > 0)
+		return;
+
+	for (auto it = sPages.begin(); it != sPages.end(); ++it)
+	{
+		if (it->get() == page)
+		{
+			sPages.erase(it);
+			break;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_TEXTURE_ATLAS_H
+#define ES_CORE_RESOURCES_TEXTURE_ATLAS_H
+
+#include "math/Vector2f.h"
+#include "platform.h"
+#include GLHEADER
+#include <memory>
+#include <vector>
+
+// Shared pages that small textures are packed into, so drawing the UI binds a handful of GL textures instead of one per icon.
+// Pixels are copied into the page in RAM and uploaded with the next bind. The room of an entry that is gone is packed
+// again, a page is freed once its last entry is gone.
+// Only to be used from the main thread, like everything else that touches GL.
+class TextureAtlas
+{
+public:
+	static const int PAGE_SIZE      = 1024;
+	static const int MAX_ENTRY_SIZE = 256; // in either direction, larger textures keep a texture of their own
+	static const int MAX_PAGES      = 4;
+
+	class Page;
+
+	// A texture's rectangle within a page
+	class Entry
+	{
+	public:
+		Entry(const std::shared_ptr<Page>& page, int x, int y, int width, int height);
+		~Entry();
+
+		// Binds the page, uploading whatever was packed into it since the last bind
+		bool bind();
+
+		// Maps a texture coordinate of the texture on its own to the one within the page
+		Vector2f mapTexCoord(const Vector2f& texCoord) const;
+
+	private:
+		std::shared_ptr<Page> mPage;
+		int mX;
+		int mY;
+		int mWidth; // with the padding
+		Vector2f mTexCoordOffset;
+		Vector2f mTexCoordScale;
+	};
+
+	// Copies the pixels into a page with room left. Returns nullptr if they are too large or all pages are full
+	static std::shared_ptr<Entry> add(const unsigned char* dataRGBA, size_t width, size_t height);
+
+	static size_t getPageCount();
+
+private:
+	friend class Entry;
+
+	// Drops the page once nothing is packed into it anymore
+	static void release(Page* page);
+
+	static std::vector<std::shared_ptr<Page> > sPages;
+};
+
+#endif // ES_CORE_RESOURCES_TEXTURE_ATLAS_H
@@ -2,19 +2,30 @@
 
 #include "math/Misc.h"
 #include "resources/ResourceManager.h"
+#include "resources/ThumbnailCache.h"
 #include "ImageIO.h"
 #include "Log.h"
+#include "Renderer.h"
 #include "platform.h"
 #include GLHEADER
 #include <nanosvg/nanosvg.h>
 #include <nanosvg/nanosvgrast.h>
 #include <assert.h>
+#include <fstream>
 #include <string.h>
 
 #define DPI 96
 
+// enough for the header of about any PNG/GIF/BMP and of JPEGs without huge embedded metadata
+#define PROBE_SIZE (64 * 1024)
+
+std::atomic<size_t> TextureData::sTotalRAMUsage(0);
+std::atomic<size_t> TextureData::sTotalVRAMUsage(0);
+std::atomic<size_t> TextureData::sTotalSize(0);
+
 TextureData::TextureData(bool tile) : mTile(tile), mTextureID(0), mDataRGBA(nullptr), mScalable(false),
-									  mWidth(0), mHeight(0), mSourceWidth(0.0f), mSourceHeight(0.0f)
+									  mWidth(0), mHeight(0), mMaxWidth(0), mMaxHeight(0), mSourceWidth(0.0f), mSourceHeight(0.0f),
+									  mCountedRAM(0), mCountedVRAM(0), mCountedSize(0)
 {
 }
 
@@ -22,6 +33,29 @@ TextureData::~TextureData()
 {
 	releaseVRAM();
 	releaseRAM();
+
+	// take whatever is left out of the totals
+	std::unique_lock<std::mutex> lock(mMutex);
+	mWidth = 0;
+	mHeight = 0;
+	updateMemUsage();
+}
+
+static void adjustTotal(std::atomic<size_t>& total, size_t& counted, const size_t value)
+{
+	if (value > counted)
+		total += value - counted;
+	else
+		total -= counted - value;
+	counted = value;
+}
+
+void TextureData::updateMemUsage()
+{
+	const size_t size = mWidth * mHeight * 4;
+	adjustTotal(sTotalRAMUsage, mCountedRAM, mDataRGBA ? size : 0);
+	adjustTotal(sTotalVRAMUsage, mCountedVRAM, (mTextureID != 0) ? size : 0);
+	adjustTotal(sTotalSize, mCountedSize, size);
 }
 
 void TextureData::initFromPath(const std::string& path)
@@ -32,6 +66,29 @@ void TextureData::initFromPath(const std::string& path)
 	mReloadable = true;
 }
 
+void TextureData::setMaxSize(size_t width, size_t height)
+{
+	mMaxWidth = width;
+	mMaxHeight = height;
+}
+
+void TextureData::getFittedSize(size_t width, size_t height, size_t& fittedWidth, size_t& fittedHeight) const
+{
+	float scale = 1.0f;
+	if ((mMaxWidth != 0) && (width > mMaxWidth))
+		scale = (float)mMaxWidth / width;
+	if ((mMaxHeight != 0) && (height > mMaxHeight))
+		scale = Math::min(scale, (float)mMaxHeight / height);
+
+	fittedWidth = width;
+	fittedHeight = height;
+	if (scale < 1.0f)
+	{
+		fittedWidth = Math::max(1, (int)Math::round(width * scale));
+		fittedHeight = Math::max(1, (int)Math::round(height * scale));
+	}
+}
+
 bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length)
 {
 	// If already initialised then don't read again
@@ -76,13 +133,13 @@ bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length
 
 	unsigned char* dataRGBA = new unsigned char[mWidth * mHeight * 4];
 
+	// rasterized bottom row first, starting at the last row with a negative stride, so it doesn't have to be flipped afterwards
 	NSVGrasterizer* rast = nsvgCreateRasterizer();
-	nsvgRasterize(rast, svgImage, 0, 0, mHeight / svgImage->height, dataRGBA, (int)mWidth, (int)mHeight, (int)mWidth * 4);
+	nsvgRasterize(rast, svgImage, 0, 0, mHeight / svgImage->height, dataRGBA + ((mHeight - 1) * mWidth * 4), (int)mWidth, (int)mHeight, -(int)mWidth * 4);
 	nsvgDeleteRasterizer(rast);
 
-	ImageIO::flipPixelsVert(dataRGBA, mWidth, mHeight);
-
 	mDataRGBA = dataRGBA;
+	updateMemUsage();
 
 	return true;
 }
@@ -98,8 +155,9 @@ bool TextureData::initImageFromMemory(const unsigned char* fileData, size_t leng
 			return true;
 	}
 
-	std::vector<unsigned char> imageRGBA = ImageIO::loadFromMemoryRGBA32((const unsigned char*)(fileData), length, width, height);
-	if (imageRGBA.size() == 0)
+	// decoded straight into a buffer this texture can keep, so the pixels aren't copied once more
+	unsigned char* imageRGBA = ImageIO::loadFromMemoryRGBA32Buffer((const unsigned char*)(fileData), length, width, height);
+	if (imageRGBA == nullptr)
 	{
 		LOG(LogError) << "Could not initialize texture from memory, invalid data!  (file path: " << mPath << ", data ptr: " << (size_t)fileData << ", reported size: " << length << ")";
 		return false;
@@ -109,7 +167,47 @@ bool TextureData::initImageFromMemory(const unsigned char* fileData, size_t leng
 	mSourceHeight = (float) height;
 	mScalable = false;
 
-	return initFromRGBA(imageRGBA.data(), width, height);
+	// no point in keeping more pixels than it will ever be drawn with
+	size_t fittedWidth, fittedHeight;
+	getFittedSize(width, height, fittedWidth, fittedHeight);
+	if ((fittedWidth != width) || (fittedHeight != height))
+	{
+		unsigned char* fittedRGBA = new unsigned char[fittedWidth * fittedHeight * 4];
+		ImageIO::shrinkRGBA32(imageRGBA, width, height, fittedRGBA, fittedWidth, fittedHeight);
+		delete[] imageRGBA;
+
+		// next time it can skip the decode and the shrinking
+		if (!mPath.empty())
+			ThumbnailCache::save(ResourceManager::getInstance()->getResourcePath(mPath), mMaxWidth, mMaxHeight, fittedRGBA, fittedWidth, fittedHeight, width, height);
+
+		return adoptRGBA(fittedRGBA, fittedWidth, fittedHeight);
+	}
+
+	return adoptRGBA(imageRGBA, width, height);
+}
+
+bool TextureData::initFromThumbnailCache()
+{
+	// only shrunk bitmaps are cached
+	if ((mMaxWidth == 0) && (mMaxHeight == 0))
+		return false;
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (mDataRGBA)
+			return true;
+	}
+
+	size_t width, height, sourceWidth, sourceHeight;
+	unsigned char* dataRGBA = ThumbnailCache::load(ResourceManager::getInstance()->getResourcePath(mPath), mMaxWidth, mMaxHeight, width, height, sourceWidth, sourceHeight);
+	if (!dataRGBA)
+		return false;
+
+	mSourceWidth = (float)sourceWidth;
+	mSourceHeight = (float)sourceHeight;
+	mScalable = false;
+
+	return adoptRGBA(dataRGBA, width, height);
 }
 
 bool TextureData::initFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height)
@@ -124,6 +222,24 @@ bool TextureData::initFromRGBA(const unsigned char* dataRGBA, size_t width, size
 	memcpy(mDataRGBA, dataRGBA, width * height * 4);
 	mWidth = width;
 	mHeight = height;
+	updateMemUsage();
+	return true;
+}
+
+bool TextureData::adoptRGBA(unsigned char* dataRGBA, size_t width, size_t height)
+{
+	// If already initialised then don't read again
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mDataRGBA)
+	{
+		delete[] dataRGBA;
+		return true;
+	}
+
+	mDataRGBA = dataRGBA;
+	mWidth = width;
+	mHeight = height;
+	updateMemUsage();
 	return true;
 }
 
@@ -135,19 +251,89 @@ bool TextureData::load()
 	if (!mPath.empty())
 	{
 		std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
-		const ResourceData& data = rm->getFileData(mPath);
 		// is it an SVG?
 		if (mPath.substr(mPath.size() - 4, std::string::npos) == ".svg")
 		{
+			const ResourceData& data = rm->getFileData(mPath);
 			mScalable = true;
 			retval = initSVGFromMemory((const unsigned char*)data.ptr.get(), data.length);
 		}
-		else
+		else if (!initFromThumbnailCache())
+		{
+			const ResourceData& data = rm->getFileData(mPath);
 			retval = initImageFromMemory((const unsigned char*)data.ptr.get(), data.length);
+		}
+		else
+			retval = true;
 	}
 	return retval;
 }
 
+bool TextureData::probeSize()
+{
+	if (mPath.empty())
+		return false;
+
+	std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
+
+	// is it an SVG? those have to be parsed to know their size, but at least they don't need to be rasterized
+	if (mPath.substr(mPath.size() - 4, std::string::npos) == ".svg")
+	{
+		const ResourceData& data = rm->getFileData(mPath);
+		if (!data.ptr)
+			return false;
+
+		// nsvgParse excepts a modifiable, null-terminated string
+		char* copy = (char*)malloc(data.length + 1);
+		assert(copy != NULL);
+		memcpy(copy, data.ptr.get(), data.length);
+		copy[data.length] = '\0';
+
+		NSVGimage* svgImage = nsvgParse(copy, "px", DPI);
+		free(copy);
+		if (!svgImage)
+			return false;
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mScalable = true;
+		if ((mSourceWidth == 0.0f) && (mSourceHeight == 0.0f))
+		{
+			mSourceWidth = svgImage->width;
+			mSourceHeight = svgImage->height;
+		}
+		mWidth = (size_t)Math::round(mSourceWidth);
+		mHeight = (size_t)Math::round(mSourceHeight);
+
+		if (mWidth == 0)
+			mWidth = (size_t)Math::round(((float)mHeight / svgImage->height) * svgImage->width);
+		else if (mHeight == 0)
+			mHeight = (size_t)Math::round(((float)mWidth / svgImage->width) * svgImage->height);
+		updateMemUsage();
+
+		nsvgDelete(svgImage);
+		return (mWidth != 0) && (mHeight != 0);
+	}
+
+	std::ifstream stream(rm->getResourcePath(mPath), std::ios::in | std::ios::binary);
+	if (!stream.is_open())
+		return false;
+
+	std::vector<unsigned char> header(PROBE_SIZE);
+	stream.read((char*)header.data(), header.size());
+
+	size_t width, height;
+	if (!ImageIO::getImageSize(header.data(), (size_t)stream.gcount(), width, height))
+		return false;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	getFittedSize(width, height, mWidth, mHeight);
+	mSourceWidth = (float)width;
+	mSourceHeight = (float)height;
+	mScalable = false;
+	updateMemUsage();
+	return true;
+}
+
 bool TextureData::isLoaded()
 {
 	std::unique_lock<std::mutex> lock(mMutex);
@@ -156,13 +342,25 @@ bool TextureData::isLoaded()
 	return false;
 }
 
+bool TextureData::isInRAM()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return mDataRGBA != nullptr;
+}
+
+bool TextureData::isInVRAM()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return mTextureID != 0;
+}
+
 bool TextureData::uploadAndBind()
 {
 	// See if it's already been uploaded
 	std::unique_lock<std::mutex> lock(mMutex);
 	if (mTextureID != 0)
 	{
-		glBindTexture(GL_TEXTURE_2D, mTextureID);
+		Renderer::bindTexture(mTextureID);
 	}
 	else
 	{
@@ -174,30 +372,32 @@ bool TextureData::uploadAndBind()
 		// Make sure we're ready to upload
 		if ((mWidth == 0) || (mHeight == 0) || (mDataRGBA == nullptr))
 			return false;
-		glGetError();
 		//now for the openGL texture stuff
-		glGenTextures(1, &mTextureID);
-		glBindTexture(GL_TEXTURE_2D, mTextureID);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)mWidth, (GLsizei)mHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, mDataRGBA);
+		mTextureID = Renderer::createTexture((unsigned int)mWidth, (unsigned int)mHeight, GL_RGBA, true, mTile, mDataRGBA);
+		updateMemUsage();
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-		const GLint wrapMode = mTile ? GL_REPEAT : GL_CLAMP_TO_EDGE;
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+		Renderer::bindTexture(mTextureID);
 	}
 	return true;
 }
 
+std::shared_ptr<TextureAtlas::Entry> TextureData::addToAtlas()
+{
+	// tiled textures need GL_REPEAT, which a part of a page can't do
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mTile)
+		return nullptr;
+	return TextureAtlas::add(mDataRGBA, mWidth, mHeight);
+}
+
 void TextureData::releaseVRAM()
 {
 	std::unique_lock<std::mutex> lock(mMutex);
 	if (mTextureID != 0)
 	{
-		glDeleteTextures(1, &mTextureID);
+		Renderer::destroyTexture(mTextureID);
 		mTextureID = 0;
+		updateMemUsage();
 	}
 }
 
@@ -206,6 +406,7 @@ void TextureData::releaseRAM()
 	std::unique_lock<std::mutex> lock(mMutex);
 	delete[] mDataRGBA;
 	mDataRGBA = 0;
+	updateMemUsage();
 }
 
 size_t TextureData::width()
@@ -257,3 +458,23 @@ size_t TextureData::getVRAMUsage()
 	else
 		return 0;
 }
+
+size_t TextureData::getDataSize()
+{
+	return mWidth * mHeight * 4;
+}
+
+size_t TextureData::getTotalRAMUsage()
+{
+	return sTotalRAMUsage;
+}
+
+size_t TextureData::getTotalVRAMUsage()
+{
+	return sTotalVRAMUsage;
+}
+
+size_t TextureData::getTotalSize()
+{
+	return sTotalSize;
+}
@@ -2,8 +2,10 @@
 #ifndef ES_CORE_RESOURCES_TEXTURE_DATA_H
 #define ES_CORE_RESOURCES_TEXTURE_DATA_H
 
+#include "resources/TextureAtlas.h"
 #include "platform.h"
 #include GLHEADER
+#include <atomic>
 #include <mutex>
 #include <string>
 
@@ -19,6 +21,8 @@ public:
 
 	//!!!! Needs to be canonical path. Caller should check for duplicates before calling this
 	void initFromPath(const std::string& path);
+	// Bitmaps larger than this are shrunk to fit when they are decoded, 0 = no limit on that axis
+	void setMaxSize(size_t width, size_t height);
 	bool initSVGFromMemory(const unsigned char* fileData, size_t length);
 	bool initImageFromMemory(const unsigned char* fileData, size_t length);
 	bool initFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height);
@@ -26,12 +30,22 @@ public:
 	// Read the data into memory if necessary
 	bool load();
 
+	// Reads the dimensions from the file header without decoding it, so the actual load can be left to the loader thread.
+	// Returns false if they couldn't be found, the texture then has to be loaded to know its size.
+	bool probeSize();
+
 	bool isLoaded();
+	// Whether the decoded pixels are in RAM / the texture is uploaded to VRAM
+	bool isInRAM();
+	bool isInVRAM();
 
 	// Upload the texture to VRAM if necessary and bind. Returns true if bound ok or
 	// false if either not loaded
 	bool uploadAndBind();
 
+	// Copies the decoded pixels into a shared atlas page. Returns nullptr if they aren't in RAM or don't fit
+	std::shared_ptr<TextureAtlas::Entry> addToAtlas();
+
 	// Release the texture from VRAM
 	void releaseVRAM();
 
@@ -41,6 +55,14 @@ public:
 	// Get the amount of VRAM currenty used by this texture
 	size_t getVRAMUsage();
 
+	// Bytes this texture takes once loaded, 0 while its size isn't known. Unlike width() this never loads it
+	size_t getDataSize();
+
+	// Running totals over all textures, kept up to date as they are loaded and released so reading them is cheap
+	static size_t getTotalRAMUsage();  // decoded bitmaps held in RAM
+	static size_t getTotalVRAMUsage(); // uploaded to VRAM
+	static size_t getTotalSize();      // all textures whose size is known, loaded or not
+
 	size_t width();
 	size_t height();
 	float sourceWidth();
@@ -50,6 +72,22 @@ public:
 	bool tiled() { return mTile; }
 
 private:
+	// Takes the bitmap from the thumbnail cache if it has an up to date copy at the max size
+	bool initFromThumbnailCache();
+
+	// Like initFromRGBA, but takes ownership of the new[] allocated buffer instead of copying it
+	bool adoptRGBA(unsigned char* dataRGBA, size_t width, size_t height);
+
+	// The size a width x height bitmap ends up at once it is fit within the max size
+	void getFittedSize(size_t width, size_t height, size_t& fittedWidth, size_t& fittedHeight) const;
+
+	// Brings the running totals up to date with the state of this texture, mMutex has to be held
+	void updateMemUsage();
+
+	static std::atomic<size_t> sTotalRAMUsage;
+	static std::atomic<size_t> sTotalVRAMUsage;
+	static std::atomic<size_t> sTotalSize;
+
 	std::mutex		mMutex;
 	bool			mTile;
 	std::string		mPath;
@@ -57,10 +95,16 @@ private:
 	unsigned char*	mDataRGBA;
 	size_t			mWidth;
 	size_t			mHeight;
+	size_t			mMaxWidth;
+	size_t			mMaxHeight;
 	float			mSourceWidth;
 	float			mSourceHeight;
 	bool			mScalable;
 	bool			mReloadable;
+	// what this texture currently adds to each of the totals
+	size_t			mCountedRAM;
+	size_t			mCountedVRAM;
+	size_t			mCountedSize;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_DATA_H
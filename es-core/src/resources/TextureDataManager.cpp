@@ -2,7 +2,9 @@
 
 #include "resources/TextureData.h"
 #include "resources/TextureResource.h"
+#include "Profiler.h"
 #include "Settings.h"
+#include <SDL_events.h>
 
 TextureDataManager::TextureDataManager()
 {
@@ -16,7 +18,11 @@ TextureDataManager::TextureDataManager()
 		data[i*4+3] = 0;
 	}
 	mBlank->initFromRGBA(data, 5, 5);
-	mLoader = new TextureLoader;
+	mLoader = nullptr;
+	mVRAMHits = 0;
+	mVRAMMisses = 0;
+	mRAMHits = 0;
+	mRAMMisses = 0;
 }
 
 TextureDataManager::~TextureDataManager()
@@ -28,174 +34,302 @@ std::shared_ptr<TextureData> TextureDataManager::add(const TextureResource* key,
 {
 	remove(key);
 	std::shared_ptr<TextureData> data(new TextureData(tiled));
-	mTextures.push_front(data);
-	mTextureLookup[key] = mTextures.cbegin();
+	TextureEntry& entry = mTextures[key];
+	entry.data = data;
+	entry.vramIt = mVRAMTextures.end();
+	// it may be loaded right away, without get()
+	entry.ramIt = mRAMTextures.end();
+	touch(mRAMTextures, entry.ramIt, key);
 	return data;
 }
 
 void TextureDataManager::remove(const TextureResource* key)
 {
 	// Find the entry in the list
-	auto it = mTextureLookup.find(key);
-	if (it != mTextureLookup.cend())
+	auto it = mTextures.find(key);
+	if (it != mTextures.cend())
 	{
-		// Remove the list entry
-		mTextures.erase((*it).second);
+		// Nobody is going to draw it anymore, so don't bother loading it
+		if (mLoader)
+			mLoader->remove(it->second.data);
+		// Remove it from the tiers
+		if (it->second.ramIt != mRAMTextures.end())
+			mRAMTextures.erase(it->second.ramIt);
+		if (it->second.vramIt != mVRAMTextures.end())
+			mVRAMTextures.erase(it->second.vramIt);
 		// And the lookup
-		mTextureLookup.erase(it);
+		mTextures.erase(it);
 	}
 }
 
-std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key)
+void TextureDataManager::touch(Tier& tier, Tier::iterator& it, const TextureResource* key)
 {
-	// If it's in the cache then we want to remove it from it's current location and
-	// move it to the top
+	if (it != tier.end())
+	{
+		tier.splice(tier.begin(), tier, it);
+	}
+	else
+	{
+		tier.push_front(key);
+		it = tier.begin();
+	}
+}
+
+std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key, TextureLoader::Lane lane)
+{
+	// If it's in the cache then it's the most recently used in RAM now, whether it's loaded
+	// already or about to be
 	std::shared_ptr<TextureData> tex;
-	auto it = mTextureLookup.find(key);
-	if (it != mTextureLookup.cend())
+	auto it = mTextures.find(key);
+	if (it != mTextures.end())
 	{
-		tex = *(*it).second;
-		// Remove the list entry
-		mTextures.erase((*it).second);
-		// Put it at the top
-		mTextures.push_front(tex);
-		// Store it back in the lookup
-		mTextureLookup[key] = mTextures.cbegin();
+		tex = it->second.data;
+		touch(mRAMTextures, it->second.ramIt, key);
 
 		// Make sure it's loaded or queued for loading
-		load(tex);
+		load(tex, false, lane);
 	}
 	return tex;
 }
 
 bool TextureDataManager::bind(const TextureResource* key)
 {
-	std::shared_ptr<TextureData> tex = get(key);
+	std::shared_ptr<TextureData> tex = get(key, TextureLoader::LANE_VISIBLE);
 	bool bound = false;
 	if (tex != nullptr)
+	{
+		if (tex->isInVRAM())
+		{
+			mVRAMHits++;
+		}
+		else
+		{
+			mVRAMMisses++;
+			if (tex->isInRAM())
+			{
+				// It's about to be uploaded from RAM, make sure it fits
+				mRAMHits++;
+				makeRoomInVRAM(tex->getDataSize());
+			}
+			else
+				mRAMMisses++;
+		}
 		bound = tex->uploadAndBind();
+		if (bound)
+			touch(mVRAMTextures, mTextures[key].vramIt, key);
+	}
 	if (!bound)
 		mBlank->uploadAndBind();
 	return bound;
 }
 
-size_t TextureDataManager::getTotalSize()
+size_t TextureDataManager::getQueueSize()
 {
-	size_t total = 0;
-	for (auto tex : mTextures)
-		total += tex->width() * tex->height() * 4;
-	return total;
+	return mLoader ? mLoader->getQueueSize() : 0;
 }
 
-size_t TextureDataManager::getCommittedSize()
+size_t TextureDataManager::getQueueDepth(TextureLoader::Lane lane)
 {
-	size_t total = 0;
-	for (auto tex : mTextures)
-		total += tex->getVRAMUsage();
-	return total;
+	return mLoader ? mLoader->getQueueDepth(lane) : 0;
 }
 
-size_t TextureDataManager::getQueueSize()
+void TextureDataManager::waitForLoads()
+{
+	if (mLoader)
+		mLoader->waitUntilIdle();
+}
+
+unsigned int TextureDataManager::getLoadedCount()
 {
-	return mLoader->getQueueSize();
+	return mLoader ? mLoader->getLoadedCount() : 0;
 }
 
-void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
+void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block, TextureLoader::Lane lane)
 {
 	// See if it's already loaded
 	if (tex->isLoaded())
 		return;
-	// Not loaded. Make sure there is room
-	size_t size = TextureResource::getTotalMemUsage();
-	size_t max_texture = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
-
-	for (auto it = mTextures.crbegin(); it != mTextures.crend(); ++it)
+	// Not loaded. Make sure there is room for its pixels once they are decoded
+	makeRoomInRAM(tex->getDataSize());
+	if (!block)
 	{
-		if (size < max_texture)
-			break;
-		//size -= (*it)->getVRAMUsage();
-		(*it)->releaseVRAM();
-		(*it)->releaseRAM();
-		// It may be already in the loader queue. In this case it wouldn't have been using
-		// any VRAM yet but it will be. Remove it from the loader queue
-		mLoader->remove(*it);
-		size = TextureResource::getTotalMemUsage();
+		if (!mLoader)
+			mLoader = new TextureLoader((unsigned int)Settings::getInstance()->getInt("TextureLoaderThreads"));
+		mLoader->load(tex, lane);
 	}
-	if (!block)
-		mLoader->load(tex);
 	else
 		tex->load();
 }
 
-TextureLoader::TextureLoader() : mExit(false)
+float TextureDataManager::getVRAMHitRate()
+{
+	const size_t lookups = mVRAMHits + mVRAMMisses;
+	return lookups ? ((float)mVRAMHits / lookups) : 0.0f;
+}
+
+float TextureDataManager::getRAMHitRate()
+{
+	const size_t lookups = mRAMHits + mRAMMisses;
+	return lookups ? ((float)mRAMHits / lookups) : 0.0f;
+}
+
+void TextureDataManager::makeRoomInVRAM(size_t size)
+{
+	// 0 = unlimited
+	const size_t max_vram = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
+	if (max_vram == 0)
+		return;
+
+	// Only the VRAM copy goes, the pixels stay in RAM so it can be uploaded again without reading the file.
+	// A texture that was released from VRAM some other way is simply taken off the list
+	while (!mVRAMTextures.empty() && ((TextureData::getTotalVRAMUsage() + size) > max_vram))
+	{
+		TextureEntry& entry = mTextures[mVRAMTextures.back()];
+		mVRAMTextures.pop_back();
+		entry.vramIt = mVRAMTextures.end();
+		entry.data->releaseVRAM();
+	}
+}
+
+void TextureDataManager::makeRoomInRAM(size_t size)
+{
+	// 0 = unlimited
+	const size_t max_ram = (size_t)Settings::getInstance()->getInt("MaxTextureRAM") * 1024 * 1024;
+	if (max_ram == 0)
+		return;
+
+	// Textures waiting in the loader queue will take their share once they are decoded
+	while (!mRAMTextures.empty() && ((TextureData::getTotalRAMUsage() + getQueueSize() + size) > max_ram))
+	{
+		TextureEntry& entry = mTextures[mRAMTextures.back()];
+		mRAMTextures.pop_back();
+		entry.ramIt = mRAMTextures.end();
+		// A texture that is still in VRAM remains drawable, it just has to be read from disk again once it is evicted from there too
+		entry.data->releaseRAM();
+		// It may be already in the loader queue. In this case it wouldn't have been using
+		// any RAM yet but it will be. Remove it from the loader queue
+		if (mLoader)
+			mLoader->remove(entry.data);
+	}
+}
+
+TextureLoader::TextureLoader(unsigned int numThreads) : mQueueSize(0), mLoadedCount(0), mExit(false)
 {
-	mThread = new std::thread(&TextureLoader::threadProc, this);
+	// hardware_concurrency() is allowed to return 0 if it can't tell
+	if (numThreads == 0)
+	{
+		const unsigned int cores = std::thread::hardware_concurrency();
+		numThreads = (cores > 1) ? (cores - 1) : 1;
+	}
+
+	for (unsigned int i = 0; i < numThreads; ++i)
+		mThreads.push_back(new std::thread(&TextureLoader::threadProc, this));
 }
 
 TextureLoader::~TextureLoader()
 {
 	// Just abort any waiting texture
-	mTextureDataQ.clear();
-	mTextureDataLookup.clear();
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		for (int i = 0; i < LANE_COUNT; ++i)
+			mTextureDataQ[i].clear();
+		mTextureDataLookup.clear();
+		mQueueSize = 0;
 
-	// Exit the thread
-	mExit = true;
-	mEvent.notify_one();
-	mThread->join();
-	delete mThread;
+		mExit = true;
+	}
+
+	// Exit the threads
+	mEvent.notify_all();
+	mIdleEvent.notify_all();
+	for (auto thread : mThreads)
+	{
+		thread->join();
+		delete thread;
+	}
+}
+
+unsigned int TextureLoader::getLoadedEventType()
+{
+	static const unsigned int type = SDL_RegisterEvents(1);
+	return type;
 }
 
 void TextureLoader::threadProc()
 {
-	while (!mExit)
+	while (true)
 	{
 		std::shared_ptr<TextureData> textureData;
 		{
 			// Wait for an event to say there is something in the queue
 			std::unique_lock<std::mutex> lock(mMutex);
-			mEvent.wait(lock);
-			if (!mTextureDataQ.empty())
+			mEvent.wait(lock, [this] { return mExit || !mTextureDataLookup.empty(); });
+			if (mExit)
+				return;
+
+			// Take the most recent request from the most urgent lane
+			for (int i = 0; i < LANE_COUNT; ++i)
 			{
-				textureData = mTextureDataQ.front();
-				mTextureDataQ.pop_front();
-				mTextureDataLookup.erase(mTextureDataLookup.find(textureData.get()));
+				if (!mTextureDataQ[i].empty())
+				{
+					textureData = mTextureDataQ[i].front();
+					break;
+				}
 			}
+			dequeue(mTextureDataLookup.find(textureData.get()));
+			mLoading.insert(textureData.get());
 		}
-		// Queue has been released here but we might have a texture to process
-		while (textureData)
+
+		// Queue has been released here so the other threads can pick up their next texture
 		{
+			PROFILE_SCOPE("TextureLoader::load");
 			textureData->load();
+		}
+		mLoadedCount++;
 
-			// See if there is another item in the queue
-			textureData = nullptr;
-			std::unique_lock<std::mutex> lock(mMutex);
-			if (!mTextureDataQ.empty())
-			{
-				textureData = mTextureDataQ.front();
-				mTextureDataQ.pop_front();
-				mTextureDataLookup.erase(mTextureDataLookup.find(textureData.get()));
-			}
+		// one queued event wakes the main loop for all textures done until it gets to it
+		const unsigned int loadedEventType = getLoadedEventType();
+		if (loadedEventType != (unsigned int)-1 && !SDL_HasEvent(loadedEventType))
+		{
+			SDL_Event event;
+			SDL_zero(event);
+			event.type = loadedEventType;
+			SDL_PushEvent(&event);
 		}
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mLoading.erase(textureData.get());
+		if (mLoading.empty() && mTextureDataLookup.empty())
+			mIdleEvent.notify_all();
 	}
 }
 
-void TextureLoader::load(std::shared_ptr<TextureData> textureData)
+void TextureLoader::load(std::shared_ptr<TextureData> textureData, Lane lane)
 {
 	// Make sure it's not already loaded
 	if (!textureData->isLoaded())
 	{
 		std::unique_lock<std::mutex> lock(mMutex);
-		// Remove it from the queue if it is already there
+		// Another thread is on it already
+		if (mLoading.find(textureData.get()) != mLoading.cend())
+			return;
+
+		// Remove it from the queue if it is already there, it keeps the more urgent of both lanes
 		auto td = mTextureDataLookup.find(textureData.get());
 		if (td != mTextureDataLookup.cend())
 		{
-			mTextureDataQ.erase((*td).second);
-			mTextureDataLookup.erase(td);
+			if (td->second.lane < lane)
+				lane = td->second.lane;
+			dequeue(td);
 		}
 
 		// Put it on the start of the queue as we want the newly requested textures to load first
-		mTextureDataQ.push_front(textureData);
-		mTextureDataLookup[textureData.get()] = mTextureDataQ.cbegin();
+		mTextureDataQ[lane].push_front(textureData);
+		QueuedTextureData& queued = mTextureDataLookup[textureData.get()];
+		queued.lane = lane;
+		queued.it = mTextureDataQ[lane].cbegin();
+		queued.size = textureData->getDataSize();
+		mQueueSize += queued.size;
 		mEvent.notify_one();
 	}
 }
@@ -206,21 +340,33 @@ void TextureLoader::remove(std::shared_ptr<TextureData> textureData)
 	std::unique_lock<std::mutex> lock(mMutex);
 	auto td = mTextureDataLookup.find(textureData.get());
 	if (td != mTextureDataLookup.cend())
-	{
-		mTextureDataQ.erase((*td).second);
-		mTextureDataLookup.erase(td);
-	}
+		dequeue(td);
+	if (mLoading.empty() && mTextureDataLookup.empty())
+		mIdleEvent.notify_all();
+}
+
+void TextureLoader::dequeue(std::map<TextureData*, QueuedTextureData>::iterator td)
+{
+	mQueueSize -= td->second.size;
+	mTextureDataQ[td->second.lane].erase(td->second.it);
+	mTextureDataLookup.erase(td);
 }
 
 size_t TextureLoader::getQueueSize()
 {
 	// Gets the amount of video memory that will be used once all textures in
 	// the queue are loaded
-	size_t mem = 0;
+	return mQueueSize;
+}
+
+size_t TextureLoader::getQueueDepth(Lane lane)
+{
 	std::unique_lock<std::mutex> lock(mMutex);
-	for (auto tex : mTextureDataQ)
-	{
-		mem += tex->width() * tex->height() * 4;
-	}
-	return mem;
+	return mTextureDataQ[lane].size();
+}
+
+void TextureLoader::waitUntilIdle()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mIdleEvent.wait(lock, [this] { return mExit || (mLoading.empty() && mTextureDataLookup.empty()); });
 }
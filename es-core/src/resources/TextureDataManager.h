@@ -2,12 +2,15 @@
 #ifndef ES_CORE_RESOURCES_TEXTURE_DATA_MANAGER_H
 #define ES_CORE_RESOURCES_TEXTURE_DATA_MANAGER_H
 
+#include <atomic>
 #include <condition_variable>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <thread>
+#include <vector>
 
 class TextureData;
 class TextureResource;
@@ -15,24 +18,60 @@ class TextureResource;
 class TextureLoader
 {
 public:
-	TextureLoader();
+	// Queued textures are loaded lane by lane, the most recently requested first within a lane
+	enum Lane
+	{
+		LANE_VISIBLE,    // drawn right now
+		LANE_PREFETCH,   // just created, likely to be drawn soon
+		LANE_BACKGROUND, // anything else
+		LANE_COUNT
+	};
+
+	TextureLoader(unsigned int numThreads); // 0 = one per CPU core, leaving one for the main thread
 	~TextureLoader();
 
-	void load(std::shared_ptr<TextureData> textureData);
+	// Queues the texture in the lane, or moves it up to it if it is queued in a lower one already
+	void load(std::shared_ptr<TextureData> textureData, Lane lane);
 	void remove(std::shared_ptr<TextureData> textureData);
 
+	// Bytes the queued textures will take once loaded
 	size_t getQueueSize();
+	size_t getQueueDepth(Lane lane);
+
+	// Blocks until nothing is queued or being loaded anymore
+	void waitUntilIdle();
+
+	// How many textures have been loaded so far, goes up whenever there is something new to draw
+	unsigned int getLoadedCount() const { return mLoadedCount; }
+
+	// SDL event pushed when a texture finished loading, so a main loop waiting for input wakes up to draw it
+	static unsigned int getLoadedEventType();
 
 private:
-	void processQueue();
+	typedef std::list<std::shared_ptr<TextureData> > TextureDataQueue;
+
+	struct QueuedTextureData
+	{
+		Lane lane;
+		TextureDataQueue::const_iterator it;
+		size_t size; // what it added to mQueueSize
+	};
+
+	// Takes a queued texture out of its lane, mMutex has to be held
+	void dequeue(std::map<TextureData*, QueuedTextureData>::iterator td);
+
 	void threadProc();
 
-	std::list<std::shared_ptr<TextureData> > 										mTextureDataQ;
-	std::map<TextureData*, std::list<std::shared_ptr<TextureData> >::const_iterator > 	mTextureDataLookup;
+	TextureDataQueue 									mTextureDataQ[LANE_COUNT];
+	std::map<TextureData*, QueuedTextureData> 			mTextureDataLookup;
+	std::set<TextureData*>								mLoading; // being loaded by one of the threads right now
+	std::atomic<size_t>									mQueueSize;
+	std::atomic<unsigned int>							mLoadedCount;
 
-	std::thread*				mThread;
+	std::vector<std::thread*>	mThreads;
 	std::mutex					mMutex;
 	std::condition_variable		mEvent;
+	std::condition_variable		mIdleEvent;
 	bool 						mExit;
 };
 
@@ -46,9 +85,13 @@ private:
 //
 // Once the load is complete (which may not be on the first call to get() if the
 // data is loaded in a background thread) then the get() function call uploadAndBind()
-// to upload to VRAM if necessary and bind the texture. This is followed by a call
-// to releaseRAM() which frees the memory buffer if the texture can be reloaded from
-// disk if needed again
+// to upload to VRAM if necessary and bind the texture.
+//
+// Textures are kept in two tiers with their own budget, both evicted least recently
+// used first: uploaded textures in VRAM (MaxVRAM) and decoded pixels in RAM (MaxTextureRAM).
+// A texture evicted from VRAM keeps its pixels in RAM as long as they fit, so it can be
+// uploaded again without going back to the disk. Each tier has a list of its own, so
+// evicting only ever looks at textures that hold something in it.
 //
 class TextureDataManager
 {
@@ -63,25 +106,51 @@ public:
 	// will be deleted when the other thread has finished with it
 	void remove(const TextureResource* key);
 
-	std::shared_ptr<TextureData> get(const TextureResource* key);
+	std::shared_ptr<TextureData> get(const TextureResource* key, TextureLoader::Lane lane = TextureLoader::LANE_BACKGROUND);
 	bool bind(const TextureResource* key);
 
-	// Get the total size of all textures managed by this object, loaded and unloaded in bytes
-	size_t	getTotalSize();
-	// Get the total size of all committed textures (in VRAM) in bytes
-	size_t	getCommittedSize();
 	// Get the total size of all load-pending textures in the queue - these will
 	// be committed to VRAM as the queue is processed
 	size_t  getQueueSize();
+	// Get the number of textures waiting in one of the loader lanes
+	size_t  getQueueDepth(TextureLoader::Lane lane);
+	// Wait for the loader to finish everything it was asked to load
+	void waitForLoads();
+	// Get the number of textures the loader has finished so far
+	unsigned int getLoadedCount();
 	// Load a texture, freeing resources as necessary to make space
-	void load(std::shared_ptr<TextureData> tex, bool block = false);
+	void load(std::shared_ptr<TextureData> tex, bool block = false, TextureLoader::Lane lane = TextureLoader::LANE_BACKGROUND);
 
-private:
+	// Share of the lookups served by each tier: VRAM is looked up on every bind, RAM on every bind that missed VRAM
+	float	getVRAMHitRate();
+	float	getRAMHitRate();
 
-	std::list<std::shared_ptr<TextureData> >												mTextures;
-	std::map<const TextureResource*, std::list<std::shared_ptr<TextureData> >::const_iterator > 	mTextureLookup;
-	std::shared_ptr<TextureData>															mBlank;
-	TextureLoader*																			mLoader;
+private:
+	typedef std::list<const TextureResource*> Tier; // most recently used first
+
+	struct TextureEntry
+	{
+		std::shared_ptr<TextureData> data;
+		Tier::iterator ramIt;  // in mRAMTextures while loaded or queued for loading, mRAMTextures.end() otherwise
+		Tier::iterator vramIt; // in mVRAMTextures while uploaded, mVRAMTextures.end() otherwise
+	};
+
+	// Moves the texture to the front of the tier, adding it if it isn't in there
+	static void touch(Tier& tier, Tier::iterator& it, const TextureResource* key);
+
+	// Evict the least recently used textures from a tier until size more bytes fit in its budget
+	void makeRoomInVRAM(size_t size);
+	void makeRoomInRAM(size_t size);
+
+	std::map<const TextureResource*, TextureEntry>	mTextures;
+	Tier											mRAMTextures;
+	Tier											mVRAMTextures;
+	std::shared_ptr<TextureData>					mBlank;
+	TextureLoader*									mLoader; // created on first use, once the settings are loaded
+	size_t											mVRAMHits;
+	size_t											mVRAMMisses;
+	size_t											mRAMHits;
+	size_t											mRAMMisses;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_DATA_MANAGER_H
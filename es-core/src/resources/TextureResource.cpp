@@ -1,14 +1,17 @@
 #include "resources/TextureResource.h"
 
+#include "math/Misc.h"
 #include "utils/FileSystemUtil.h"
 #include "resources/TextureData.h"
 
 TextureDataManager		TextureResource::sTextureDataManager;
 std::map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource> > TextureResource::sTextureMap;
-std::set<TextureResource*> 	TextureResource::sAllTextures;
 
-TextureResource::TextureResource(const std::string& path, bool tile, bool dynamic) : mTextureData(nullptr), mForceLoad(false)
+TextureResource::TextureResource(const std::string& path, bool tile, bool dynamic, const Vector2i& maxSize) : mTextureData(nullptr), mForceLoad(false)
 {
+	// theme and game artwork changes too often to share pages, only what's built in or loaded for good is packed
+	mAtlasCandidate = !tile && !path.empty() && (((path[0] == ':') && (path[1] == '/')) || !dynamic);
+
 	// Create a texture data object for this texture
 	if (!path.empty())
 	{
@@ -19,8 +22,11 @@ TextureResource::TextureResource(const std::string& path, bool tile, bool dynami
 		{
 			data = sTextureDataManager.add(this, tile);
 			data->initFromPath(path);
-			// Force the texture manager to load it using a blocking load
-			sTextureDataManager.load(data, true);
+			data->setMaxSize((size_t)maxSize.x(), (size_t)maxSize.y());
+			// The size is all we need for now, the texture manager loads it once it's drawn.
+			// Force a blocking load only if the header doesn't tell
+			if (!data->probeSize())
+				sTextureDataManager.load(data, true);
 		}
 		else
 		{
@@ -39,15 +45,12 @@ TextureResource::TextureResource(const std::string& path, bool tile, bool dynami
 		// Create a texture managed by this class because it cannot be dynamically loaded and unloaded
 		mTextureData = std::shared_ptr<TextureData>(new TextureData(tile));
 	}
-	sAllTextures.insert(this);
 }
 
 TextureResource::~TextureResource()
 {
 	if (mTextureData == nullptr)
 		sTextureDataManager.remove(this);
-
-	sAllTextures.erase(sAllTextures.find(this));
 }
 
 void TextureResource::initFromPixels(const unsigned char* dataRGBA, size_t width, size_t height)
@@ -89,6 +92,9 @@ bool TextureResource::isTiled() const
 
 bool TextureResource::bind()
 {
+	if (mAtlasEntry || packIntoAtlas())
+		return mAtlasEntry->bind();
+
 	if (mTextureData != nullptr)
 	{
 		mTextureData->uploadAndBind();
@@ -100,7 +106,35 @@ bool TextureResource::bind()
 	}
 }
 
-std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, bool tile, bool forceLoad, bool dynamic)
+Vector2f TextureResource::mapTexCoord(const Vector2f& texCoord) const
+{
+	return mAtlasEntry ? mAtlasEntry->mapTexCoord(texCoord) : texCoord;
+}
+
+bool TextureResource::packIntoAtlas()
+{
+	if (!mAtlasCandidate)
+		return false;
+
+	std::shared_ptr<TextureData> data = (mTextureData != nullptr) ? mTextureData : sTextureDataManager.get(this, TextureLoader::LANE_VISIBLE);
+	// Not decoded yet, try again with the next bind
+	if (!data || !data->isInRAM())
+		return false;
+
+	mAtlasEntry = data->addToAtlas();
+	if (!mAtlasEntry)
+	{
+		// Too large or the atlas is full, it keeps a texture of its own
+		mAtlasCandidate = false;
+		return false;
+	}
+
+	// The page has a copy of the pixels, the texture of its own isn't needed anymore
+	data->releaseVRAM();
+	return true;
+}
+
+std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, bool tile, bool forceLoad, bool dynamic, const Vector2f& maxSize)
 {
 	std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
 
@@ -112,7 +146,13 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 		return tex;
 	}
 
-	TextureKeyType key(canonicalPath, tile);
+	// only bitmaps are shrunk, tiled ones need all their pixels and SVGs are rasterized at the size they are drawn at anyway
+	const bool isSVG = canonicalPath.substr(canonicalPath.size() - 4, std::string::npos) == ".svg";
+	Vector2i fitSize = Vector2i::Zero();
+	if (dynamic && !tile && !isSVG)
+		fitSize = Vector2i((int)Math::ceilf(maxSize.x()), (int)Math::ceilf(maxSize.y()));
+
+	TextureKeyType key(canonicalPath, tile, fitSize.x(), fitSize.y());
 	auto foundTexture = sTextureMap.find(key);
 	if(foundTexture != sTextureMap.cend())
 	{
@@ -122,11 +162,11 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 
 	// need to create it
 	std::shared_ptr<TextureResource> tex;
-	tex = std::shared_ptr<TextureResource>(new TextureResource(key.first, tile, dynamic));
-	std::shared_ptr<TextureData> data = sTextureDataManager.get(tex.get());
+	tex = std::shared_ptr<TextureResource>(new TextureResource(canonicalPath, tile, dynamic, fitSize));
+	std::shared_ptr<TextureData> data = sTextureDataManager.get(tex.get(), TextureLoader::LANE_PREFETCH);
 
 	// is it an SVG?
-	if(key.first.substr(key.first.size() - 4, std::string::npos) != ".svg")
+	if(!isSVG)
 	{
 		// Probably not. Add it to our map. We don't add SVGs because 2 svgs might be rasterized at different sizes
 		sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
@@ -153,6 +193,9 @@ void TextureResource::rasterizeAt(size_t width, size_t height)
 		data = mTextureData;
 	else
 		data = sTextureDataManager.get(this);
+	// Rasterized at another size, it has to be packed again
+	if (mSourceSize != Vector2f((float)width, (float)height))
+		mAtlasEntry.reset();
 	mSourceSize = Vector2f((float)width, (float)height);
 	data->setSourceSize((float)width, (float)height);
 	if (mForceLoad || (mTextureData != nullptr))
@@ -169,39 +212,50 @@ bool TextureResource::isInitialized() const
 	return true;
 }
 
-size_t TextureResource::getTotalMemUsage()
+size_t TextureResource::getTotalVRAMUsage()
 {
-	size_t total = 0;
-	// Count up all textures that manage their own texture data
-	for (auto tex : sAllTextures)
-	{
-		if (tex->mTextureData != nullptr)
-			total += tex->mTextureData->getVRAMUsage();
-	}
-	// Now get the committed memory from the manager
-	total += sTextureDataManager.getCommittedSize();
-	// And the size of the loading queue
-	total += sTextureDataManager.getQueueSize();
-	return total;
+	return TextureData::getTotalVRAMUsage();
+}
+
+size_t TextureResource::getTotalRAMUsage()
+{
+	return TextureData::getTotalRAMUsage() + sTextureDataManager.getQueueSize();
+}
+
+float TextureResource::getVRAMHitRate()
+{
+	return sTextureDataManager.getVRAMHitRate();
+}
+
+float TextureResource::getRAMHitRate()
+{
+	return sTextureDataManager.getRAMHitRate();
+}
+
+size_t TextureResource::getQueueDepth(TextureLoader::Lane lane)
+{
+	return sTextureDataManager.getQueueDepth(lane);
+}
+
+void TextureResource::waitForLoads()
+{
+	sTextureDataManager.waitForLoads();
+}
+
+unsigned int TextureResource::getLoadedCount()
+{
+	return sTextureDataManager.getLoadedCount();
 }
 
 size_t TextureResource::getTotalTextureSize()
 {
-	size_t total = 0;
-	// Count up all textures that manage their own texture data
-	for (auto tex : sAllTextures)
-	{
-		if (tex->mTextureData != nullptr)
-			total += tex->getSize().x() * tex->getSize().y() * 4;
-	}
-	// Now get the total memory from the manager
-	total += sTextureDataManager.getTotalSize();
-	return total;
+	return TextureData::getTotalSize();
 }
 
 void TextureResource::unload(std::shared_ptr<ResourceManager>& /*rm*/)
 {
 	// Release the texture's resources
+	mAtlasEntry.reset();
 	std::shared_ptr<TextureData> data;
 	if (mTextureData == nullptr)
 		data = sTextureDataManager.get(this);
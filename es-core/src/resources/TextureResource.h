@@ -5,9 +5,10 @@
 #include "math/Vector2i.h"
 #include "math/Vector2f.h"
 #include "resources/ResourceManager.h"
+#include "resources/TextureAtlas.h"
 #include "resources/TextureDataManager.h"
-#include <set>
 #include <string>
+#include <tuple>
 
 class TextureData;
 
@@ -16,7 +17,8 @@ class TextureData;
 class TextureResource : public IReloadable
 {
 public:
-	static std::shared_ptr<TextureResource> get(const std::string& path, bool tile = false, bool forceLoad = false, bool dynamic = true);
+	// A non-zero maxSize lets a dynamic bitmap be shrunk to that size when it is decoded, it is then kept apart from the full size one
+	static std::shared_ptr<TextureResource> get(const std::string& path, bool tile = false, bool forceLoad = false, bool dynamic = true, const Vector2f& maxSize = Vector2f::Zero());
 	void initFromPixels(const unsigned char* dataRGBA, size_t width, size_t height);
 	virtual void initFromMemory(const char* file, size_t length);
 
@@ -32,15 +34,29 @@ public:
 	const Vector2i getSize() const;
 	bool bind();
 
-	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by textures (in bytes)
+	// Small built-in and non-dynamic textures are packed into a shared atlas page with their first bind. Texture
+	// coordinates have to be mapped to their rectangle in there, which this does after bind() and leaves alone otherwise
+	Vector2f mapTexCoord(const Vector2f& texCoord) const;
+	bool isInAtlas() const { return mAtlasEntry != nullptr; }
+
+	static size_t getTotalVRAMUsage(); // returns an approximation of total VRAM used by textures (in bytes)
+	static size_t getTotalRAMUsage(); // returns the bytes of decoded textures held in RAM, including the ones still in the loading queue
+	static float getVRAMHitRate(); // returns the share of binds that found the texture in VRAM
+	static float getRAMHitRate(); // returns the share of the other binds that could upload it from RAM without reading the file
 	static size_t getTotalTextureSize(); // returns the number of bytes that would be used if all textures were in memory
+	static size_t getQueueDepth(TextureLoader::Lane lane); // returns the number of textures waiting to be loaded in a lane
+	static void waitForLoads(); // blocks until the loader threads have nothing left to do, so frames come out the same every run
+	static unsigned int getLoadedCount(); // returns how many textures the loader threads have finished, a change means there is something new to draw
 
 protected:
-	TextureResource(const std::string& path, bool tile, bool dynamic);
+	TextureResource(const std::string& path, bool tile, bool dynamic, const Vector2i& maxSize = Vector2i::Zero());
 	virtual void unload(std::shared_ptr<ResourceManager>& rm);
 	virtual void reload(std::shared_ptr<ResourceManager>& rm);
 
 private:
+	// Returns true if the texture is (now) in an atlas page
+	bool packIntoAtlas();
+
 	// mTextureData is used for textures that are not loaded from a file - these ones
 	// are permanently allocated and cannot be loaded and unloaded based on resources
 	std::shared_ptr<TextureData>		mTextureData;
@@ -51,10 +67,11 @@ private:
 	Vector2i					mSize;
 	Vector2f					mSourceSize;
 	bool							mForceLoad;
+	bool							mAtlasCandidate; // until it turns out to be too large for the atlas
+	std::shared_ptr<TextureAtlas::Entry>	mAtlasEntry;
 
-	typedef std::pair<std::string, bool> TextureKeyType;
+	typedef std::tuple<std::string, bool, int, int> TextureKeyType; // path, tile, max width, max height
 	static std::map< TextureKeyType, std::weak_ptr<TextureResource> > sTextureMap; // map of textures, used to prevent duplicate textures
-	static std::set<TextureResource*> 	sAllTextures;	// Set of all textures, used for memory management
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_RESOURCE_H
@@ -0,0 +1,148 @@
+#include "resources/ThumbnailCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "CacheFile.h"
+#include "Settings.h"
+#include <algorithm>
+#include <functional>
+#include <stdio.h>
+
+// bump this whenever the layout below changes, old entries are then simply ignored
+static const char     CACHE_MAGIC[4] = { 'E', 'S', 'T', 'C' };
+static const uint32_t CACHE_VERSION  = 2;
+
+// source path, max size, source file size/mtime, source dimensions, dimensions, then the raw RGBA pixels
+static const size_t HEADER_SIZE = 4 + 4 + 4 + 4 + 4 + 8 + 8 + 4 + 4 + 4 + 4; // and the source path
+
+// an entry used again within this many seconds keeps its time, so not every load writes to the disk
+static const time_t TOUCH_INTERVAL = 60 * 60;
+
+std::mutex ThumbnailCache::sMutex;
+bool       ThumbnailCache::sScanned   = false;
+long long  ThumbnailCache::sTotalSize = 0;
+
+unsigned char* ThumbnailCache::load(const std::string& path, size_t maxWidth, size_t maxHeight,
+                                    size_t& width, size_t& height, size_t& sourceWidth, size_t& sourceHeight)
+{
+	if(Settings::getInstance()->getInt("ThumbnailCacheSize") <= 0)
+		return NULL;
+
+	// only the header is read into the reader, the pixels go straight into the texture's buffer
+	const std::string entryPath = getEntryPath(path, maxWidth, maxHeight);
+	CacheReader reader;
+	if(!reader.load(entryPath, CACHE_MAGIC, CACHE_VERSION, HEADER_SIZE + path.size()))
+		return NULL;
+
+	std::string sourcePath;
+	uint32_t    entryMaxWidth, entryMaxHeight;
+	int64_t     fileSize, fileTime;
+	uint32_t    entrySourceWidth, entrySourceHeight, entryWidth, entryHeight;
+
+	if(!reader.readString(&sourcePath) || sourcePath != path ||
+	   !reader.read(&entryMaxWidth) || entryMaxWidth != maxWidth || !reader.read(&entryMaxHeight) || entryMaxHeight != maxHeight ||
+	   !reader.read(&fileSize) || fileSize != (int64_t)Utils::FileSystem::getFileSize(path) ||
+	   !reader.read(&fileTime) || fileTime != (int64_t)Utils::FileSystem::getModifiedTimeNs(path) ||
+	   !reader.read(&entrySourceWidth) || !reader.read(&entrySourceHeight) || !reader.read(&entryWidth) || !reader.read(&entryHeight))
+		return NULL;
+
+	const size_t size = (size_t)entryWidth * entryHeight * 4;
+	if(size == 0)
+		return NULL;
+
+	unsigned char* dataRGBA = new unsigned char[size];
+	if(!reader.readToEnd(dataRGBA, size))
+	{
+		delete[] dataRGBA;
+		return NULL;
+	}
+
+	// used just now, so it's the last to go
+	const time_t now = time(NULL);
+	if(Utils::FileSystem::getModifiedTime(entryPath) + TOUCH_INTERVAL < now)
+		Utils::FileSystem::setModifiedTime(entryPath, now);
+
+	width        = entryWidth;
+	height       = entryHeight;
+	sourceWidth  = entrySourceWidth;
+	sourceHeight = entrySourceHeight;
+	return dataRGBA;
+}
+
+void ThumbnailCache::save(const std::string& path, size_t maxWidth, size_t maxHeight, const unsigned char* dataRGBA,
+                          size_t width, size_t height, size_t sourceWidth, size_t sourceHeight)
+{
+	if(Settings::getInstance()->getInt("ThumbnailCacheSize") <= 0)
+		return;
+
+	CacheWriter writer(CACHE_MAGIC, CACHE_VERSION);
+
+	writer.writeString(path);
+	writer.write((uint32_t)maxWidth);
+	writer.write((uint32_t)maxHeight);
+	writer.write((int64_t)Utils::FileSystem::getFileSize(path));
+	writer.write((int64_t)Utils::FileSystem::getModifiedTimeNs(path));
+	writer.write((uint32_t)sourceWidth);
+	writer.write((uint32_t)sourceHeight);
+	writer.write((uint32_t)width);
+	writer.write((uint32_t)height);
+	writer.writeBytes(dataRGBA, width * height * 4);
+
+	const std::string entryPath = getEntryPath(path, maxWidth, maxHeight);
+
+	{
+		std::unique_lock<std::mutex> lock(sMutex);
+
+		// an outdated entry for the same key is replaced
+		const long long oldSize = Utils::FileSystem::getFileSize(entryPath);
+		if(oldSize > 0)
+			sTotalSize -= oldSize;
+
+		makeRoom(writer.getSize());
+	}
+
+	if(writer.save(entryPath))
+	{
+		std::unique_lock<std::mutex> lock(sMutex);
+		sTotalSize += writer.getSize();
+	}
+}
+
+std::string ThumbnailCache::getEntryPath(const std::string& path, size_t maxWidth, size_t maxHeight)
+{
+	char name[64];
+	snprintf(name, sizeof(name), "%016llx-%ux%u.bin", (unsigned long long)std::hash<std::string>()(path), (unsigned int)maxWidth, (unsigned int)maxHeight);
+	return getCacheFilePath(std::string("thumbnails/") + name);
+}
+
+void ThumbnailCache::makeRoom(size_t size)
+{
+	const long long maxSize = (long long)Settings::getInstance()->getInt("ThumbnailCacheSize") * 1024 * 1024;
+	const std::string folder = getCacheFilePath("thumbnails");
+
+	// the directory is only walked the first time, from then on the total is kept up to date here
+	if(!sScanned)
+	{
+		const Utils::FileSystem::stringList entries = Utils::FileSystem::getDirContent(folder);
+		for(auto it = entries.cbegin(); it != entries.cend(); ++it)
+			sTotalSize += std::max(0LL, Utils::FileSystem::getFileSize(*it));
+		sScanned = true;
+	}
+
+	if(sTotalSize + (long long)size <= maxSize)
+		return;
+
+	// least recently used first
+	std::vector<std::pair<time_t, std::string>> entries;
+	const Utils::FileSystem::stringList files = Utils::FileSystem::getDirContent(folder);
+	for(auto it = files.cbegin(); it != files.cend(); ++it)
+		entries.push_back(std::make_pair(Utils::FileSystem::getModifiedTime(*it), *it));
+	std::sort(entries.begin(), entries.end());
+
+	// drop down to 90% so this doesn't happen again for every single new entry
+	for(auto it = entries.cbegin(); it != entries.cend() && (sTotalSize + (long long)size > maxSize * 9 / 10); ++it)
+	{
+		const long long entrySize = Utils::FileSystem::getFileSize(it->second);
+		if(Utils::FileSystem::removeFile(it->second) && entrySize > 0)
+			sTotalSize -= entrySize;
+	}
+}
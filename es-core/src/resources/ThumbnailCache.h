@@ -0,0 +1,35 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_THUMBNAIL_CACHE_H
+#define ES_CORE_RESOURCES_THUMBNAIL_CACHE_H
+
+#include <mutex>
+#include <string>
+
+// Shrunk, already decoded bitmaps in ~/.emulationstation/cache/thumbnails/, so artwork that is shown smaller than it is
+// doesn't have to be decoded and resampled again in every session. Entries are keyed by source path and max size and are
+// only used while the source file keeps its size and modification time. The least recently used entries are dropped
+// once the directory grows beyond ThumbnailCacheSize megabytes, 0 disables the cache.
+class ThumbnailCache
+{
+public:
+	// Returns the cached bitmap of path shrunk to fit maxWidth x maxHeight, new[] allocated for the caller to own, or NULL
+	// if there is none
+	static unsigned char* load(const std::string& path, size_t maxWidth, size_t maxHeight,
+	                           size_t& width, size_t& height, size_t& sourceWidth, size_t& sourceHeight);
+
+	static void save(const std::string& path, size_t maxWidth, size_t maxHeight, const unsigned char* dataRGBA,
+	                 size_t width, size_t height, size_t sourceWidth, size_t sourceHeight);
+
+private:
+	static std::string getEntryPath(const std::string& path, size_t maxWidth, size_t maxHeight);
+
+	// Deletes the least recently used entries until another size bytes fit. An entry's modification time is when it
+	// was last used, load() moves it forward
+	static void makeRoom(size_t size);
+
+	static std::mutex sMutex;
+	static bool       sScanned;   // whether sTotalSize has been summed up yet
+	static long long  sTotalSize; // of all entries, in bytes
+};
+
+#endif // ES_CORE_RESOURCES_THUMBNAIL_CACHE_H
@@ -4,22 +4,27 @@
 
 #include "Settings.h"
 #include <sys/stat.h>
+#include <stdio.h>
 #include <string.h>
 
 #if defined(_WIN32)
 // because windows...
 #include <direct.h>
+#include <sys/utime.h>
 #include <Windows.h>
 #define getcwd _getcwd
 #define mkdir(x,y) _mkdir(x)
 #define snprintf _snprintf
 #define stat64 _stat64
 #define unlink _unlink
+#define utime _utime
+#define utimbuf _utimbuf
 #define S_ISREG(x) (((x) & S_IFMT) == S_IFREG)
 #define S_ISDIR(x) (((x) & S_IFMT) == S_IFDIR)
 #else // _WIN32
 #include <dirent.h>
 #include <unistd.h>
+#include <utime.h>
 #endif // _WIN32
 
 namespace Utils
@@ -533,6 +538,21 @@ namespace Utils
 
 		} // removeFile
 
+		bool renameFile(const std::string& _source, const std::string& _destination)
+		{
+			std::string source      = getGenericPath(_source);
+			std::string destination = getGenericPath(_destination);
+
+#if defined(_WIN32)
+			// rename() refuses to replace an existing file on windows
+			return (MoveFileEx(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else // _WIN32
+			// rename() atomically replaces the destination
+			return (rename(source.c_str(), destination.c_str()) == 0);
+#endif // _WIN32
+
+		} // renameFile
+
 		bool createDirectory(const std::string& _path)
 		{
 			std::string path = getGenericPath(_path);
@@ -668,6 +688,72 @@ namespace Utils
 
 		} // isEquivalent
 
+		long long getFileSize(const std::string& _path)
+		{
+			std::string path = getGenericPath(_path);
+			struct stat64 info;
+
+			// check if stat64 succeeded
+			if(stat64(path.c_str(), &info) != 0)
+				return -1;
+
+			return (long long)info.st_size;
+
+		} // getFileSize
+
+		time_t getModifiedTime(const std::string& _path)
+		{
+			std::string path = getGenericPath(_path);
+			struct stat64 info;
+
+			// check if stat64 succeeded
+			if(stat64(path.c_str(), &info) != 0)
+				return 0;
+
+			return info.st_mtime;
+
+		} // getModifiedTime
+
+		long long getModifiedTimeNs(const std::string& _path)
+		{
+			std::string path = getGenericPath(_path);
+
+#if defined(_WIN32)
+			// _stat64 only has whole seconds, the file times count 100ns steps since 1601
+			WIN32_FILE_ATTRIBUTE_DATA info;
+			if(!GetFileAttributesExW(std::wstring(path.begin(), path.end()).c_str(), GetFileExInfoStandard, &info))
+				return 0;
+
+			const long long time = ((long long)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+			return (time - 116444736000000000LL) * 100;
+#else // _WIN32
+			struct stat64 info;
+
+			// check if stat64 succeeded
+			if(stat64(path.c_str(), &info) != 0)
+				return 0;
+
+#if defined(__APPLE__)
+			return ((long long)info.st_mtimespec.tv_sec * 1000000000LL) + info.st_mtimespec.tv_nsec;
+#else // __APPLE__
+			return ((long long)info.st_mtim.tv_sec * 1000000000LL) + info.st_mtim.tv_nsec;
+#endif // __APPLE__
+#endif // _WIN32
+
+		} // getModifiedTimeNs
+
+		bool setModifiedTime(const std::string& _path, const time_t _time)
+		{
+			std::string path = getGenericPath(_path);
+			struct utimbuf times;
+
+			times.actime  = _time;
+			times.modtime = _time;
+
+			return (utime(path.c_str(), &times) == 0);
+
+		} // setModifiedTime
+
 	} // FileSystem::
 
 } // Utils::
@@ -4,6 +4,7 @@
 
 #include <list>
 #include <string>
+#include <time.h>
 
 namespace Utils
 {
@@ -30,6 +31,7 @@ namespace Utils
 		std::string removeCommonPath   (const std::string& _path, const std::string& _common, bool& _contains);
 		std::string resolveSymlink     (const std::string& _path);
 		bool        removeFile         (const std::string& _path);
+		bool        renameFile         (const std::string& _source, const std::string& _destination); // replaces _destination if it exists
 		bool        createDirectory    (const std::string& _path);
 		bool        exists             (const std::string& _path);
 		bool        isAbsolute         (const std::string& _path);
@@ -38,6 +40,10 @@ namespace Utils
 		bool        isSymlink          (const std::string& _path);
 		bool        isHidden           (const std::string& _path);
 		bool        isEquivalent       (const std::string& _path1, const std::string& _path2);
+		long long   getFileSize        (const std::string& _path); // -1 if it doesn't exist
+		time_t      getModifiedTime    (const std::string& _path); //  0 if it doesn't exist
+		long long   getModifiedTimeNs  (const std::string& _path); //  in nanoseconds, as precise as the file system keeps it, 0 if it doesn't exist
+		bool        setModifiedTime    (const std::string& _path, const time_t _time);
 
 	} // FileSystem::
 
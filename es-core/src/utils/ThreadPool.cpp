@@ -0,0 +1,113 @@
+#include "utils/ThreadPool.h"
+
+#include <chrono>
+
+namespace Utils
+{
+	static thread_local bool sIsWorkerThread = false;
+
+	ThreadPool::ThreadPool(const unsigned int _numThreads) : mPending(0), mExit(false)
+	{
+		unsigned int numThreads = _numThreads;
+
+		// hardware_concurrency() is allowed to return 0 if it can't tell
+		if(numThreads == 0)
+			numThreads = std::thread::hardware_concurrency();
+		if(numThreads == 0)
+			numThreads = 1;
+
+		for(unsigned int i = 0; i < numThreads; ++i)
+			mThreads.push_back(std::thread(&ThreadPool::threadProc, this));
+
+	} // ThreadPool
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mJobs.clear();
+			mExit = true;
+		}
+
+		mJobEvent.notify_all();
+
+		for(auto it = mThreads.begin(); it != mThreads.end(); ++it)
+			it->join();
+
+	} // ~ThreadPool
+
+	void ThreadPool::queueJob(const Job& _job)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mJobs.push_back(_job);
+			++mPending;
+		}
+
+		mJobEvent.notify_one();
+
+	} // queueJob
+
+	void ThreadPool::wait()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDoneEvent.wait(lock, [this] { return mPending == 0; });
+
+	} // wait
+
+	void ThreadPool::wait(const WaitCallback& _callback, const int _interval)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		while(mPending > 0)
+		{
+			const size_t pending = mPending;
+
+			// don't hold the lock while the callback does its thing (usually rendering)
+			lock.unlock();
+			_callback(pending);
+			lock.lock();
+
+			mDoneEvent.wait_for(lock, std::chrono::milliseconds(_interval), [this] { return mPending == 0; });
+		}
+
+	} // wait
+
+	bool ThreadPool::isWorkerThread()
+	{
+		return sIsWorkerThread;
+
+	} // isWorkerThread
+
+	void ThreadPool::threadProc()
+	{
+		sIsWorkerThread = true;
+
+		while(true)
+		{
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mJobEvent.wait(lock, [this] { return mExit || !mJobs.empty(); });
+
+				if(mExit)
+					return;
+
+				job = mJobs.front();
+				mJobs.pop_front();
+			}
+
+			job();
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				--mPending;
+			}
+
+			mDoneEvent.notify_all();
+		}
+
+	} // threadProc
+
+} // Utils::
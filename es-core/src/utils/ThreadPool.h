@@ -0,0 +1,49 @@
+#pragma once
+#ifndef ES_CORE_UTILS_THREAD_POOL_H
+#define ES_CORE_UTILS_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+	// A small fixed size pool of worker threads draining a FIFO of jobs.
+	// Jobs must not touch the renderer, it is only safe to use from the main thread.
+	class ThreadPool
+	{
+	public:
+
+		typedef std::function<void()> Job;
+		typedef std::function<void(const size_t _pending)> WaitCallback;
+
+		 ThreadPool(const unsigned int _numThreads = 0); // 0 = one thread per hardware core
+		~ThreadPool();
+
+		void         queueJob      (const Job& _job);
+		void         wait          (); // blocks until every queued job has completed
+		void         wait          (const WaitCallback& _callback, const int _interval); // as above, calling _callback every _interval ms on the waiting thread
+		unsigned int getThreadCount() const { return (unsigned int)mThreads.size(); }
+
+		static bool  isWorkerThread(); // true on the threads of any pool, jobs can tell they shouldn't start a pool of their own
+
+	private:
+
+		void threadProc();
+
+		std::vector<std::thread> mThreads;
+		std::list<Job>           mJobs;
+		std::mutex               mMutex;
+		std::condition_variable  mJobEvent;
+		std::condition_variable  mDoneEvent;
+		size_t                   mPending;
+		bool                     mExit;
+
+	}; // ThreadPool
+
+} // Utils::
+
+#endif // ES_CORE_UTILS_THREAD_POOL_H